@@ -230,7 +230,7 @@ extern uint32_t SystemCoreClock;
  * timer task (in words, not in bytes!).  The timer task is a standard FreeRTOS
  * task.  See https://www.freertos.org/RTOS-software-timer-service-daemon-task.html
  * Only used if configUSE_TIMERS is set to 1. */
-#define configTIMER_TASK_STACK_DEPTH    (256)
+#define configTIMER_TASK_STACK_DEPTH    (configMINIMAL_STACK_SIZE)
 
 /* configTIMER_QUEUE_LENGTH sets the length of the queue (the number of discrete
  * items the queue can hold) used to send commands to the timer task.  See
@@ -634,16 +634,16 @@ void vAssertFailed(const char* file, uint16_t line);
 #define INCLUDE_vTaskSuspend                   0
 #define INCLUDE_xResumeFromISR                 0
 #define INCLUDE_vTaskDelayUntil                0
-#define INCLUDE_vTaskDelay                     0
+#define INCLUDE_vTaskDelay                     1
 #define INCLUDE_xTaskGetSchedulerState         0
 #define INCLUDE_xTaskGetCurrentTaskHandle      1
-#define INCLUDE_uxTaskGetStackHighWaterMark    0
+#define INCLUDE_uxTaskGetStackHighWaterMark    1
 #define INCLUDE_xTaskGetIdleTaskHandle         0
 #define INCLUDE_eTaskGetState                  0
 #define INCLUDE_xEventGroupSetBitFromISR       0
 #define INCLUDE_xTimerPendFunctionCall         0
 #define INCLUDE_xTaskAbortDelay                0
-#define INCLUDE_xTaskGetHandle                 0
+#define INCLUDE_xTaskGetHandle                 1
 #define INCLUDE_xTaskResumeFromISR             0
 
 #endif /* FREERTOS_CONFIG_H */
@@ -38,19 +38,22 @@ void board_dali_tx_timer_next(uint32_t count, enum board_toggle toggle)
     }
 }
 
-void board_dali_tx_timer_setup(uint32_t count)
+static void setup_tx_timer(uint32_t start, uint32_t count, bool active)
 {
     LPC_TMR32B0->TCR = TMR32B0TCR_CRST;
     board_dali_tx_timer_stop();
     board_dali_tx_timer_next(count, NOTHING);
+    // release the reset, the counter starts at start
+    LPC_TMR32B0->TCR = 0;
+    LPC_TMR32B0->TC = start;
     // set prescaler to base rate
     LPC_TMR32B0->PR = (BOARD_AHB_CLOCK / DALI_TIMER_RATE_HZ) - 1;
     // set timer mode
     LPC_TMR32B0->CTCR = 0;
     // on MR3 match: IRQ
     LPC_TMR32B0->MCR = (LPC_TMR32B0->MCR & ~(TMR32B0MCR_MR3I | TMR32B0MCR_MR3R | TMR32B0MCR_MR3S)) | (TMR32B0MCR_MR3I);
-    // on MR3 match: toggle output - start with DALI active
-    LPC_TMR32B0->EMR = TMR32B0EMR_EM3 | (TMR32B0EMR_EMC3_MASK & (3 << TMR32B0EMR_EMC3_SHIFT));
+    // on MR3 match: toggle output
+    LPC_TMR32B0->EMR = (active ? TMR32B0EMR_EM3 : 0) | (TMR32B0EMR_EMC3_MASK & (3 << TMR32B0EMR_EMC3_SHIFT));
     // outputs are controlled by EMx
     LPC_TMR32B0->PWMC = 0;
     // pin function: CT32B0_MAT3
@@ -63,6 +66,19 @@ void board_dali_tx_timer_setup(uint32_t count)
     LPC_TMR32B0->TCR = TMR32B0TCR_CEN;
 }
 
+// start with DALI active, the first toggle at count
+void board_dali_tx_timer_setup(uint32_t count)
+{
+    setup_tx_timer(0, count, true);
+}
+
+// start with DALI idle, the counter wraps to 0 after the delay
+// and the first toggle drives DALI active
+void board_dali_tx_timer_setup_delayed(uint32_t delay)
+{
+    setup_tx_timer(0U - delay, 0, false);
+}
+
 void TIMER32_0_IRQHandler(void)
 {
     if (LPC_TMR32B0->IR & TMR32B0IR_MR3_INTERRUPT) {
@@ -85,6 +101,10 @@ void TIMER32_1_IRQHandler(void)
         LPC_TMR32B1->IR = TMR32B0IR_MR2_INTERRUPT;
         dali_rx_irq_query_match_callback();
     }
+    if (LPC_TMR32B1->IR & TMR32B0IR_MR3_INTERRUPT) {
+        LPC_TMR32B1->IR = TMR32B0IR_MR3_INTERRUPT;
+        dali_rx_irq_start_match_callback();
+    }
     if (LPC_TMR32B1->IR & TMR32B0IR_CR0_INTERRUPT) {
         LPC_TMR32B1->IR = TMR32B0IR_CR0_INTERRUPT;
         dali_rx_irq_capture_callback();
@@ -121,6 +141,11 @@ void board_dali_rx_set_query_match(uint32_t match_count)
     LPC_TMR32B1->MR2 = match_count;
 }
 
+void board_dali_rx_set_start_match(uint32_t match_count)
+{
+    LPC_TMR32B1->MR3 = match_count;
+}
+
 void board_dali_rx_stopbit_match_enable(bool enable)
 {
     if (enable) {
@@ -148,6 +173,15 @@ void board_dali_rx_query_match_enable(bool enable)
     }
 }
 
+void board_dali_rx_start_match_enable(bool enable)
+{
+    if (enable) {
+        LPC_TMR32B1->MCR |= (TMR32B0MCR_MR3I);
+    } else {
+        LPC_TMR32B1->MCR &= ~(TMR32B0MCR_MR3I);
+    }
+}
+
 void board_dali_rx_timer_setup(void)
 {
     LPC_TMR32B1->TCR = TMR32B0TCR_CRST;
@@ -159,6 +193,7 @@ void board_dali_rx_timer_setup(void)
     LPC_TMR32B1->CCR = (TMR32B0CCR_CAP0FE | TMR32B0CCR_CAP0RE | TMR32B0CCR_CAP0I);
     board_dali_rx_stopbit_match_enable(false);
     board_dali_rx_period_match_enable(false);
+    board_dali_rx_start_match_enable(false);
     // pin function: CT32B1_CAP0
     // function mode: enable pull up resistor
     // hysteresis disabled
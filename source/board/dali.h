@@ -21,6 +21,7 @@ void board_dali_tx_set(bool state);
 void board_dali_tx_timer_stop(void);
 void board_dali_tx_timer_next(uint32_t count, enum board_toggle toggle);
 void board_dali_tx_timer_setup(uint32_t count);
+void board_dali_tx_timer_setup_delayed(uint32_t delay);
 
 bool board_dali_rx_pin(void);
 void board_dali_rx_timer_setup(void);
@@ -32,3 +33,5 @@ void board_dali_rx_set_period_match(uint32_t match);
 void board_dali_rx_period_match_enable(bool enable);
 void board_dali_rx_set_query_match(uint32_t match_count);
 void board_dali_rx_query_match_enable(bool enable);
+void board_dali_rx_set_start_match(uint32_t match_count);
+void board_dali_rx_start_match_enable(bool enable);
@@ -0,0 +1,37 @@
+#include "iap.h"
+#include <stdbool.h> // for bool
+#include <stdint.h>  // for uint32_t, uintptr_t
+#include "board.h"   // for BOARD_MAIN_CLOCK
+#include "lpc11xx.h" // for __disable_irq, __enable_irq
+
+// see UM10398 26.8 IAP commands
+#define IAP_ENTRY_LOCATION (0x1FFF1FF1U)
+#define IAP_PREPARE_SECTORS (50U)
+#define IAP_COPY_RAM_TO_FLASH (51U)
+#define IAP_ERASE_SECTORS (52U)
+#define IAP_CMD_SUCCESS (0U)
+#define IAP_CLOCK_KHZ (BOARD_MAIN_CLOCK / 1000U)
+
+typedef void (*iap_entry)(uint32_t* command, uint32_t* result);
+
+static bool iap_call(uint32_t* command)
+{
+    uint32_t result[4];
+    ((iap_entry)IAP_ENTRY_LOCATION)(command, result);
+    return result[0] == IAP_CMD_SUCCESS;
+}
+
+// The flash can not be read while it is written, interrupts are disabled for the
+// duration of the erase, about 100 ms. IAP uses the top 32 bytes of the RAM, this
+// is the main stack, which is only used by interrupts once the scheduler runs.
+bool board_iap_write_storage(const uint32_t* data)
+{
+    uint32_t prepare[5] = { IAP_PREPARE_SECTORS, BOARD_IAP_STORAGE_SECTOR, BOARD_IAP_STORAGE_SECTOR };
+    uint32_t erase[5] = { IAP_ERASE_SECTORS, BOARD_IAP_STORAGE_SECTOR, BOARD_IAP_STORAGE_SECTOR, IAP_CLOCK_KHZ };
+    uint32_t copy[5] = { IAP_COPY_RAM_TO_FLASH, BOARD_IAP_STORAGE_ADDRESS, (uintptr_t)data, BOARD_IAP_PAGE_SIZE,
+                         IAP_CLOCK_KHZ };
+    __disable_irq();
+    const bool result = iap_call(prepare) && iap_call(erase) && iap_call(prepare) && iap_call(copy);
+    __enable_irq();
+    return result;
+}
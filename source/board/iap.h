@@ -0,0 +1,11 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+// last flash sector, reserved in the linker script
+#define BOARD_IAP_STORAGE_SECTOR (7U)
+#define BOARD_IAP_STORAGE_ADDRESS (0x00007000U)
+#define BOARD_IAP_PAGE_SIZE (256U)
+
+// copies BOARD_IAP_PAGE_SIZE bytes from data, which must be word aligned
+bool board_iap_write_storage(const uint32_t* data);
@@ -0,0 +1,140 @@
+#include <stdbool.h> // for bool, false, true
+#include <stddef.h>  // for NULL
+#include <stdint.h>  // for uint32_t, uint_fast16_t
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "dali_101_lpc/dali_101.h"
+#include "serial.h"
+#include "filter.h"
+#include "bus.h"
+#include "cache.h"
+
+// frames of other bus participants can delay our transmission,
+// the timeout applies to every single frame we wait for
+#define BUS_WAIT_MS (200U)
+
+// Transactions for the on-device engines. These functions block
+// and must only be called from the main task, which owns the bus.
+
+// the serial task can start an urgent frame at any time, so the check and the
+// start must not be separated by a task switch. Returns with the scheduler suspended.
+static void suspend_when_idle(void)
+{
+    while (true) {
+        vTaskSuspendAll();
+        if (dali_101_tx_is_idle() && !serial_urgent_is_pending()) {
+            return;
+        }
+        xTaskResumeAll();
+    }
+}
+
+void bus_suspend_when_quiet(void)
+{
+    while (true) {
+        suspend_when_idle();
+        if (dali_101_rx_is_idle()) {
+            return;
+        }
+        xTaskResumeAll();
+        vTaskDelay(1);
+    }
+}
+
+// frames of other bus participants are reported while an engine waits,
+// the same way the main loop reports them
+static void report_foreign_frame(const struct dali_rx_frame* rx_frame)
+{
+    if (filter_pass(rx_frame)) {
+        serial_print_frame(*rx_frame);
+    }
+}
+
+// a reply is a backward frame, a timeout or a corrupt frame of several responders,
+// complete foreign forward frames are no reply
+static bool is_reply(const struct dali_rx_frame* rx_frame)
+{
+    if (rx_frame->loopback) {
+        return false;
+    }
+    return (rx_frame->status != DALI_OK) || (rx_frame->length == 8U);
+}
+
+static bool wait_for_loopback(const struct dali_tx_frame frame, struct dali_rx_frame* rx_frame)
+{
+    uint_fast16_t expected = frame.repeat + 1U;
+    while (expected) {
+        if (!dali_101_get(rx_frame, BUS_WAIT_MS, false)) {
+            return false;
+        }
+        if (!rx_frame->loopback) {
+            report_foreign_frame(rx_frame);
+            continue;
+        }
+        if (rx_frame->status != DALI_OK) {
+            return false;
+        }
+        expected--;
+    }
+    return true;
+}
+
+void bus_transmit(const struct dali_tx_frame frame)
+{
+    suspend_when_idle();
+    dali_101_send(frame);
+    xTaskResumeAll();
+}
+
+void bus_transmit_at(const struct dali_tx_frame frame, uint32_t time_us)
+{
+    suspend_when_idle();
+    dali_101_send_at(frame, time_us);
+    xTaskResumeAll();
+}
+
+void bus_transmit_triggered(const struct dali_tx_frame frame, const struct dali_trigger* trigger)
+{
+    suspend_when_idle();
+    dali_101_send_triggered(frame, trigger);
+    xTaskResumeAll();
+}
+
+bool bus_send(const struct dali_tx_frame frame, struct dali_rx_frame* loopback)
+{
+    struct dali_rx_frame rx_frame = { .loopback = true, .status = DALI_ERROR_CAN_NOT_PROCESS };
+    // forward frames of the engines and the periodic jobs can change the state of the control gear
+    if (frame.type >= DALI_FRAME_FORWARD_1 && frame.type <= DALI_FRAME_FORWARD_5) {
+        cache_invalidate();
+    }
+    bus_transmit(frame);
+    const bool result = wait_for_loopback(frame, &rx_frame);
+    if (loopback) {
+        *loopback = rx_frame;
+    }
+    return result;
+}
+
+bool bus_query_with_loopback(const struct dali_tx_frame frame, struct dali_rx_frame* loopback,
+                             struct dali_rx_frame* reply)
+{
+    if (!bus_send(frame, loopback)) {
+        return false;
+    }
+    while (dali_101_get(reply, BUS_WAIT_MS, false)) {
+        if (is_reply(reply)) {
+            return true;
+        }
+        if (!reply->loopback) {
+            report_foreign_frame(reply);
+        }
+    }
+    return false;
+}
+
+bool bus_query(const struct dali_tx_frame frame, struct dali_rx_frame* reply)
+{
+    return bus_query_with_loopback(frame, NULL, reply);
+}
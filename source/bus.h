@@ -0,0 +1,70 @@
+#pragma once
+#include <stdbool.h> // for bool
+#include <stdint.h>  // for uint32_t
+struct dali_rx_frame;
+struct dali_trigger;
+struct dali_tx_frame;
+
+/**
+ * @brief Wait until the transmitter is idle and start a frame. Must be called from the main task.
+ *
+ * @param frame frame to send
+ */
+void bus_transmit(struct dali_tx_frame frame);
+
+/**
+ * @brief Wait until the transmitter is idle and arm a frame to start at a device time.
+ * Must be called from the main task.
+ *
+ * @param frame frame to send
+ * @param time_us device time in microseconds, see `dali_101_get_time`
+ */
+void bus_transmit_at(struct dali_tx_frame frame, uint32_t time_us);
+
+/**
+ * @brief Wait until the transmitter is idle and arm a frame to start after a foreign start bit.
+ * Must be called from the main task.
+ *
+ * @param frame frame to send
+ * @param trigger trigger condition
+ */
+void bus_transmit_triggered(struct dali_tx_frame frame, const struct dali_trigger* trigger);
+
+/**
+ * @brief Wait until the transmitter and the receiver are idle and suspend the scheduler, so that neither
+ * the main task nor an automatic response can start a frame. Resume with `xTaskResumeAll`.
+ * Must be called from the main task.
+ *
+ */
+void bus_suspend_when_quiet(void);
+
+/**
+ * @brief Send a frame and wait for its loopback. Must be called from the main task.
+ *
+ * @param frame frame to send
+ * @param loopback received loopback or error frame, can be `NULL`
+ * @return `true` - frame was sent
+ * @return `false` - frame was not sent, or loopback reported an error
+ */
+bool bus_send(struct dali_tx_frame frame, struct dali_rx_frame* loopback);
+
+/**
+ * @brief Send a query and wait for the reply. Must be called from the main task.
+ *
+ * @param frame query frame to send
+ * @param reply received backframe, timeout or error frame
+ * @return `true` - a reply is available
+ * @return `false` - query was not sent, or loopback reported an error
+ */
+bool bus_query(struct dali_tx_frame frame, struct dali_rx_frame* reply);
+
+/**
+ * @brief Send a query and wait for the loopback and the reply. Must be called from the main task.
+ *
+ * @param frame query frame to send
+ * @param loopback received loopback or error frame, can be `NULL`
+ * @param reply received backframe, timeout or error frame
+ * @return `true` - a reply is available
+ * @return `false` - query was not sent, or loopback reported an error
+ */
+bool bus_query_with_loopback(struct dali_tx_frame frame, struct dali_rx_frame* loopback, struct dali_rx_frame* reply);
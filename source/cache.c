@@ -0,0 +1,182 @@
+#include <stdbool.h> // for bool, false, true
+#include <stddef.h>  // for NULL
+#include <stdint.h>  // for uint8_t, uint32_t, uint_fast8_t
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "dali_101_lpc/dali_101.h"
+#include "bus.h"
+#include "cache.h"
+
+#define CACHE_QUERY_LENGTH (16U)
+#define CACHE_BACKFRAME_LENGTH (8U)
+#define CACHE_OPCODE_MASK (0xFFU)
+
+struct _opcode {
+    TickType_t max_age;
+    uint8_t opcode;
+};
+
+struct _entry {
+    TickType_t time;
+    uint16_t data;
+    uint8_t value;
+    bool timeout;
+    bool valid;
+};
+
+// opcodes are written by the serial task inside critical sections,
+// the entries are owned by the main task, only a clear resets them
+static struct _cache {
+    struct _opcode opcode[CACHE_MAX_OPCODES];
+    struct _entry entry[CACHE_MAX_ENTRIES];
+} cache = { 0 };
+
+static struct _opcode* find_opcode(uint8_t opcode)
+{
+    for (uint_fast8_t i = 0; i < CACHE_MAX_OPCODES; i++) {
+        if (cache.opcode[i].max_age && cache.opcode[i].opcode == opcode) {
+            return &cache.opcode[i];
+        }
+    }
+    return NULL;
+}
+
+static TickType_t get_max_age(uint8_t opcode)
+{
+    taskENTER_CRITICAL();
+    const struct _opcode* entry = find_opcode(opcode);
+    const TickType_t max_age = entry ? entry->max_age : 0;
+    taskEXIT_CRITICAL();
+    return max_age;
+}
+
+void cache_clear(void)
+{
+    taskENTER_CRITICAL();
+    for (uint_fast8_t i = 0; i < CACHE_MAX_OPCODES; i++) {
+        cache.opcode[i].max_age = 0;
+    }
+    for (uint_fast8_t i = 0; i < CACHE_MAX_ENTRIES; i++) {
+        cache.entry[i].valid = false;
+    }
+    taskEXIT_CRITICAL();
+}
+
+bool cache_set_age(uint8_t opcode, uint32_t max_age_ms)
+{
+    if (max_age_ms > CACHE_MAX_AGE_MS) {
+        return false;
+    }
+    bool result = true;
+    taskENTER_CRITICAL();
+    struct _opcode* entry = find_opcode(opcode);
+    if (!entry) {
+        for (uint_fast8_t i = 0; !entry && i < CACHE_MAX_OPCODES; i++) {
+            if (!cache.opcode[i].max_age) {
+                entry = &cache.opcode[i];
+            }
+        }
+    }
+    if (entry) {
+        entry->opcode = opcode;
+        entry->max_age = pdMS_TO_TICKS(max_age_ms);
+    } else {
+        result = (max_age_ms == 0);
+    }
+    taskEXIT_CRITICAL();
+    return result;
+}
+
+bool cache_is_cached(const struct dali_tx_frame* frame)
+{
+    return frame->length == CACHE_QUERY_LENGTH && get_max_age(frame->data & CACHE_OPCODE_MASK);
+}
+
+void cache_invalidate(void)
+{
+    for (uint_fast8_t i = 0; i < CACHE_MAX_ENTRIES; i++) {
+        cache.entry[i].valid = false;
+    }
+}
+
+static struct _entry* find_entry(uint16_t data)
+{
+    for (uint_fast8_t i = 0; i < CACHE_MAX_ENTRIES; i++) {
+        if (cache.entry[i].valid && cache.entry[i].data == data) {
+            return &cache.entry[i];
+        }
+    }
+    return NULL;
+}
+
+// replace an unused entry, or the oldest one
+static struct _entry* allocate_entry(uint16_t data)
+{
+    struct _entry* entry = find_entry(data);
+    if (entry) {
+        return entry;
+    }
+    entry = &cache.entry[0];
+    for (uint_fast8_t i = 0; i < CACHE_MAX_ENTRIES; i++) {
+        if (!cache.entry[i].valid) {
+            return &cache.entry[i];
+        }
+        if ((int32_t)(cache.entry[i].time - entry->time) < 0) {
+            entry = &cache.entry[i];
+        }
+    }
+    return entry;
+}
+
+static void store_reply(uint16_t data, const struct dali_rx_frame* reply, TickType_t now)
+{
+    const bool backframe = (reply->status == DALI_OK && reply->length == CACHE_BACKFRAME_LENGTH);
+    if (!backframe && reply->status != DALI_TIMEOUT) {
+        // collisions and errors are never cached
+        struct _entry* entry = find_entry(data);
+        if (entry) {
+            entry->valid = false;
+        }
+        return;
+    }
+    struct _entry* entry = allocate_entry(data);
+    *entry = (struct _entry){
+        .time = now, .data = data, .value = reply->data, .timeout = !backframe, .valid = true
+    };
+}
+
+bool cache_query(const struct cache_request* request, struct dali_rx_frame* loopback, struct dali_rx_frame* reply)
+{
+    const uint16_t data = request->frame.data;
+    const TickType_t max_age = get_max_age(data & CACHE_OPCODE_MASK);
+    const struct _entry* entry = find_entry(data);
+    TickType_t now = xTaskGetTickCount();
+    if (!request->bypass && entry && (now - entry->time) < max_age) {
+        const uint32_t timestamp = pdTICKS_TO_MS(now);
+        const uint32_t time_us = dali_101_get_time();
+        *loopback = (struct dali_rx_frame){ .loopback = true,
+                                            .status = DALI_OK,
+                                            .length = CACHE_QUERY_LENGTH,
+                                            .data = data,
+                                            .timestamp = timestamp,
+                                            .time_us = time_us };
+        if (entry->timeout) {
+            *reply = (struct dali_rx_frame){ .status = DALI_TIMEOUT, .timestamp = timestamp, .time_us = time_us };
+        } else {
+            *reply = (struct dali_rx_frame){ .status = DALI_OK,
+                                             .length = CACHE_BACKFRAME_LENGTH,
+                                             .data = entry->value,
+                                             .timestamp = timestamp,
+                                             .time_us = time_us };
+        }
+        return true;
+    }
+    if (!bus_query_with_loopback(request->frame, loopback, reply)) {
+        return false;
+    }
+    now = xTaskGetTickCount();
+    store_reply(data, reply, now);
+    return true;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <stdbool.h>               // for bool
+#include <stdint.h>                // for uint8_t, uint32_t
+#include "dali_101_lpc/dali_101.h" // for dali_rx_frame, dali_tx_frame
+
+#define CACHE_MAX_OPCODES (8U)
+#define CACHE_MAX_ENTRIES (8U)
+#define CACHE_MAX_AGE_MS (600000U)
+
+/**
+ * @brief Parameters for a query that can be answered from the cache
+ *
+ */
+struct cache_request {
+    struct dali_tx_frame frame; /**< query frame */
+    bool bypass;                /**< ignore a cached reply, always query the bus */
+};
+
+/**
+ * @brief Remove all opcodes and all cached replies
+ *
+ */
+void cache_clear(void);
+
+/**
+ * @brief Set the maximum age of cached replies for an opcode
+ *
+ * @param opcode second byte of a 16 bit query
+ * @param max_age_ms maximum age in milliseconds, 0 - do not cache this opcode
+ * @return `true` - maximum age was set
+ * @return `false` - age too large, or no more opcodes available
+ */
+bool cache_set_age(uint8_t opcode, uint32_t max_age_ms);
+
+/**
+ * @brief Check if the reply to a query frame is cached
+ *
+ * @param frame query frame
+ * @return `true` - a maximum age is set for the opcode of the frame
+ * @return `false` - frame is always sent to the bus
+ */
+bool cache_is_cached(const struct dali_tx_frame* frame);
+
+/**
+ * @brief Forget all cached replies. Must be called from the main task.
+ *
+ */
+void cache_invalidate(void);
+
+/**
+ * @brief Answer a query from the cache, or send it and cache the reply. Must be called from the main task.
+ *
+ * A cached reply is output like a transmitted query, the loopback and the reply
+ * carry the current time as timestamp.
+ *
+ * @param request query parameters
+ * @param loopback loopback or error frame
+ * @param reply cached or received backframe, timeout or error frame
+ * @return `true` - a reply is available
+ * @return `false` - query was not sent, or loopback reported an error
+ */
+bool cache_query(const struct cache_request* request, struct dali_rx_frame* loopback, struct dali_rx_frame* reply);
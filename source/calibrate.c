@@ -0,0 +1,211 @@
+#include <stdbool.h> // for bool, false, true
+#include <stddef.h>  // for NULL
+#include <stdint.h>  // for uint8_t, int32_t, uint32_t, uint_fast8_t
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "dali_101_lpc/dali_101.h"
+#include "bus.h"
+#include "serial.h"
+#include "calibrate.h"
+
+#define CALIBRATE_REPORT_SIZE (15U)
+#define CALIBRATE_FRAME_LENGTH (8U)
+#define CALIBRATE_TX_REPORT_SIZE (28U)
+#define CALIBRATE_TX_PHASE_REPORT_SIZE (10U)
+
+// backward frames with half bit and full bit phases of both levels. Another control device takes
+// them as answers to its queries and they can collide with replies of control gear, the bus must
+// be isolated during the calibration.
+static const uint8_t calibrate_pattern[] = { 0xFF, 0x00, 0x55 };
+
+// the mode is changed by the serial task, the statistics are collected by the main task,
+// both inside critical sections
+static struct _calibrate {
+    enum calibrate_tx_mode tx_mode;
+    struct dali_phase_statistics achieved;
+    uint32_t adaptations;
+} calibrate = { 0 };
+
+static int32_t to_tenths(int32_t thirds)
+{
+    return (thirds * 10) / 3;
+}
+
+// mean deviation from the nominal duration in 1/10 microseconds
+static int32_t get_mean_error(const struct dali_phase_statistics* statistics, enum dali_phase phase)
+{
+    if (statistics->count[phase] == 0) {
+        return 0;
+    }
+    return (statistics->error_sum[phase] * 10) / (3 * (int32_t)statistics->count[phase]);
+}
+
+static void put_int16(uint8_t* buffer, int32_t value)
+{
+    buffer[0] = value >> 8U;
+    buffer[1] = value;
+}
+
+static void report(const struct dali_phase_statistics* statistics, bool applied)
+{
+    uint8_t result[CALIBRATE_REPORT_SIZE];
+    serial_put_uint32(&result[0], statistics->count[DALI_PHASE_IDLE]);
+    serial_put_uint32(&result[4], statistics->count[DALI_PHASE_ACTIVE]);
+    put_int16(&result[8], get_mean_error(statistics, DALI_PHASE_IDLE));
+    put_int16(&result[10], get_mean_error(statistics, DALI_PHASE_ACTIVE));
+    put_int16(&result[12], dali_101_get_rx_asymmetry());
+    result[14] = applied;
+    serial_print_block(SERIAL_REPORT_CALIBRATION, result, sizeof(result));
+}
+
+// Falling edges are detected later than rising edges by the asymmetry, so active
+// phases are measured too short and idle phases too long by the asymmetry.
+static bool apply(const struct dali_phase_statistics* statistics)
+{
+    if (statistics->count[DALI_PHASE_IDLE] < CALIBRATE_MIN_PHASES ||
+        statistics->count[DALI_PHASE_ACTIVE] < CALIBRATE_MIN_PHASES) {
+        return false;
+    }
+    const int32_t difference = statistics->error_sum[DALI_PHASE_IDLE] / (int32_t)statistics->count[DALI_PHASE_IDLE] -
+                               statistics->error_sum[DALI_PHASE_ACTIVE] / (int32_t)statistics->count[DALI_PHASE_ACTIVE];
+    // half the difference, from 1/3 microseconds to microseconds, rounded
+    const int32_t asymmetry_us = (difference + ((difference < 0) ? -3 : 3)) / 6;
+    if (asymmetry_us > CALIBRATE_MAX_ASYMMETRY_US || asymmetry_us < -CALIBRATE_MAX_ASYMMETRY_US) {
+        return false;
+    }
+    dali_101_set_rx_asymmetry(asymmetry_us);
+    return true;
+}
+
+void calibrate_apply(void)
+{
+    calibrate.tx_mode = CALIBRATE_TX_OFF;
+    struct dali_phase_statistics statistics;
+    dali_101_get_phase_statistics(&statistics);
+    dali_101_measure_phases(DALI_MEASURE_OFF);
+    report(&statistics, apply(&statistics));
+}
+
+void calibrate_measure_foreign(void)
+{
+    taskENTER_CRITICAL();
+    calibrate.tx_mode = CALIBRATE_TX_OFF;
+    dali_101_measure_phases(DALI_MEASURE_FOREIGN);
+    taskEXIT_CRITICAL();
+}
+
+void calibrate_rx(const struct calibrate_request* request)
+{
+    taskENTER_CRITICAL();
+    calibrate.tx_mode = CALIBRATE_TX_OFF;
+    dali_101_measure_phases(DALI_MEASURE_LOOPBACK);
+    taskEXIT_CRITICAL();
+    for (uint_fast8_t i = 0; i < request->frames; i++) {
+        const struct dali_tx_frame frame = {
+            .type = DALI_FRAME_BACKWARD,
+            .length = CALIBRATE_FRAME_LENGTH,
+            .data = calibrate_pattern[i % sizeof(calibrate_pattern)],
+        };
+        if (!bus_send(frame, NULL)) {
+            break;
+        }
+    }
+    calibrate_apply();
+}
+
+// the receiver correction is applied, to get the phases as they are on the bus, in 1/3 microseconds
+static int32_t get_rx_correction(enum dali_phase phase)
+{
+    const int32_t correction = 3 * dali_101_get_rx_asymmetry();
+    return (phase == DALI_PHASE_ACTIVE) ? correction : -correction;
+}
+
+static void accumulate(const struct dali_phase_statistics* window)
+{
+    struct dali_phase_statistics* achieved = &calibrate.achieved;
+    for (enum dali_phase phase = DALI_PHASE_IDLE; phase < DALI_PHASES; phase++) {
+        const int32_t correction = get_rx_correction(phase);
+        const int32_t error_min = window->error_min[phase] + correction;
+        const int32_t error_max = window->error_max[phase] + correction;
+        if (achieved->count[phase] == 0 || error_min < achieved->error_min[phase]) {
+            achieved->error_min[phase] = error_min;
+        }
+        if (achieved->count[phase] == 0 || error_max > achieved->error_max[phase]) {
+            achieved->error_max[phase] = error_max;
+        }
+        achieved->count[phase] += window->count[phase];
+        achieved->error_sum[phase] += window->error_sum[phase] + correction * (int32_t)window->count[phase];
+    }
+}
+
+// moves the compensation by half the mean deviation, to settle without overshooting on single outliers
+static void adapt(const struct dali_phase_statistics* window)
+{
+    for (enum dali_phase phase = DALI_PHASE_IDLE; phase < DALI_PHASES; phase++) {
+        const int32_t mean_error = window->error_sum[phase] / (int32_t)window->count[phase] + get_rx_correction(phase);
+        int32_t compensation_us = dali_101_get_tx_compensation(phase) - mean_error / 6;
+        if (compensation_us > CALIBRATE_MAX_COMPENSATION_US) {
+            compensation_us = CALIBRATE_MAX_COMPENSATION_US;
+        } else if (compensation_us < -CALIBRATE_MAX_COMPENSATION_US) {
+            compensation_us = -CALIBRATE_MAX_COMPENSATION_US;
+        }
+        dali_101_set_tx_compensation(phase, compensation_us);
+    }
+    calibrate.adaptations++;
+}
+
+void calibrate_tx_configure(enum calibrate_tx_mode mode)
+{
+    taskENTER_CRITICAL();
+    calibrate.tx_mode = mode;
+    calibrate.achieved = (struct dali_phase_statistics){ 0 };
+    calibrate.adaptations = 0;
+    dali_101_measure_phases((mode == CALIBRATE_TX_OFF) ? DALI_MEASURE_OFF : DALI_MEASURE_LOOPBACK);
+    taskEXIT_CRITICAL();
+}
+
+void calibrate_tx_report(bool reset)
+{
+    uint8_t result[CALIBRATE_TX_REPORT_SIZE];
+    taskENTER_CRITICAL();
+    const struct dali_phase_statistics achieved = calibrate.achieved;
+    const uint32_t adaptations = calibrate.adaptations;
+    if (reset) {
+        calibrate.achieved = (struct dali_phase_statistics){ 0 };
+        calibrate.adaptations = 0;
+    }
+    taskEXIT_CRITICAL();
+    for (enum dali_phase phase = DALI_PHASE_IDLE; phase < DALI_PHASES; phase++) {
+        uint8_t* entry = &result[phase * CALIBRATE_TX_PHASE_REPORT_SIZE];
+        serial_put_uint32(&entry[0], achieved.count[phase]);
+        put_int16(&entry[4], get_mean_error(&achieved, phase));
+        put_int16(&entry[6], to_tenths(achieved.error_min[phase]));
+        put_int16(&entry[8], to_tenths(achieved.error_max[phase]));
+    }
+    put_int16(&result[20], dali_101_get_tx_compensation(DALI_PHASE_IDLE));
+    put_int16(&result[22], dali_101_get_tx_compensation(DALI_PHASE_ACTIVE));
+    serial_put_uint32(&result[24], adaptations);
+    serial_print_block(SERIAL_REPORT_TX_TIMING, result, sizeof(result));
+}
+
+void calibrate_run(void)
+{
+    struct dali_phase_statistics window;
+    taskENTER_CRITICAL();
+    const enum calibrate_tx_mode mode = calibrate.tx_mode;
+    if (mode != CALIBRATE_TX_OFF) {
+        dali_101_get_phase_statistics(&window);
+    }
+    const bool complete = (mode != CALIBRATE_TX_OFF) && window.count[DALI_PHASE_IDLE] >= CALIBRATE_TX_WINDOW_PHASES &&
+                          window.count[DALI_PHASE_ACTIVE] >= CALIBRATE_TX_WINDOW_PHASES;
+    if (complete) {
+        dali_101_measure_phases(DALI_MEASURE_LOOPBACK);
+        accumulate(&window);
+    }
+    taskEXIT_CRITICAL();
+    if (complete && mode == CALIBRATE_TX_ADAPT) {
+        adapt(&window);
+    }
+}
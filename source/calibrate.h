@@ -0,0 +1,67 @@
+#pragma once
+#include <stdbool.h> // for bool
+#include <stdint.h>  // for uint8_t
+
+#define CALIBRATE_MIN_PHASES (16U)
+#define CALIBRATE_MAX_ASYMMETRY_US (100)
+#define CALIBRATE_TX_WINDOW_PHASES (32U)
+#define CALIBRATE_MAX_COMPENSATION_US (100)
+
+enum calibrate_tx_mode {
+    CALIBRATE_TX_OFF = 0, /**< fixed transmitter compensation, no measurement */
+    CALIBRATE_TX_MEASURE, /**< measure the loopback of the frames sent */
+    CALIBRATE_TX_ADAPT,   /**< measure and adapt the transmitter compensation */
+    CALIBRATE_TX_MODES,
+};
+
+/**
+ * @brief Parameters for a calibration with frames sent by the interface
+ *
+ */
+struct calibrate_request {
+    uint8_t frames; /**< number of frames to send */
+};
+
+/**
+ * @brief Calibrate the receiver with the loopback of frames sent by the interface,
+ *        report the result with a block message. Must be called from the main task.
+ *        Stops the closed loop transmitter compensation. The frames are backward frames,
+ *        the bus must be isolated.
+ *
+ * @param request calibration parameters
+ */
+void calibrate_rx(const struct calibrate_request* request);
+
+/**
+ * @brief Start to measure the frames of other bus participants for a calibration of the receiver,
+ *        stops the closed loop transmitter compensation
+ *
+ */
+void calibrate_measure_foreign(void);
+
+/**
+ * @brief Calibrate the receiver with the frames measured since `calibrate_measure_foreign`,
+ *        report the result with a block message
+ *
+ */
+void calibrate_apply(void);
+
+/**
+ * @brief Select the closed loop compensation of the transmitter, resets the statistics
+ *
+ * @param mode off, measure only, or measure and adapt
+ */
+void calibrate_tx_configure(enum calibrate_tx_mode mode);
+
+/**
+ * @brief Report the timing of the frames sent since the statistics were reset with a block message
+ *
+ * @param reset `true` - reset the statistics after the report
+ */
+void calibrate_tx_report(bool reset);
+
+/**
+ * @brief Collect the measured phases and adapt the transmitter compensation. Must be called from the main task.
+ *
+ */
+void calibrate_run(void);
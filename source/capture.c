@@ -0,0 +1,242 @@
+#include <stdbool.h> // for bool, false, true
+#include <stddef.h>  // for size_t
+#include <stdint.h>  // for uint8_t, uint32_t, uint64_t, uint_fast8_t
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "board/dali.h"
+#include "dali_101_lpc/dali_101.h"
+#include "filter.h"
+#include "serial.h"
+#include "capture.h"
+
+#define CAPTURE_RING_MASK (CAPTURE_RING_SIZE - 1U)
+#define CAPTURE_EDGES_PER_MESSAGE (12U)
+#define CAPTURE_VARINT_MAX_SIZE (5U)
+#define CAPTURE_VARINT_MASK (0x7FU)
+#define CAPTURE_VARINT_MORE (0x80U)
+#define CAPTURE_EDGE_MESSAGE_SIZE (1U + CAPTURE_EDGES_PER_MESSAGE * CAPTURE_VARINT_MAX_SIZE)
+#define CAPTURE_START_MESSAGE_SIZE (6U)
+#define CAPTURE_COUNTER_MESSAGE_SIZE (9U)
+
+enum capture_kind { CAPTURE_START = 0, CAPTURE_EDGES, CAPTURE_LOST, CAPTURE_STOP, CAPTURE_TRIGGER };
+
+enum capture_state {
+    CAPTURE_OFF = 0,
+    CAPTURE_RUNNING,   /**< stream the edges */
+    CAPTURE_STOPPING,  /**< output the remaining edges */
+    CAPTURE_ARMED,     /**< keep the latest edges, wait for the trigger */
+    CAPTURE_TRIGGERED, /**< record the edges after the trigger */
+    CAPTURE_FROZEN,    /**< output the recorded edges */
+};
+
+// While streaming, the capture interrupt writes the ring at the head, the main task reads at the tail.
+// Edges that find the ring full are only counted. While armed or triggered, the capture interrupt
+// owns both ends and overwrites the oldest edge, the main task reads the ring once it is frozen.
+static struct _capture {
+    uint32_t count[CAPTURE_RING_SIZE];
+    uint32_t active;
+    volatile uint_fast8_t head;
+    uint_fast8_t tail;
+    uint32_t lost;
+    uint32_t last_count;
+    uint32_t edges;
+    uint32_t lost_total;
+    struct capture_trigger trigger;
+    uint32_t trigger_time;
+    uint_fast8_t pre;
+    uint_fast8_t post;
+    volatile enum capture_state state;
+} capture = { 0 };
+
+void capture_record(uint32_t count, bool active)
+{
+    const enum capture_state state = capture.state;
+    if (state != CAPTURE_RUNNING && state != CAPTURE_ARMED && state != CAPTURE_TRIGGERED) {
+        return;
+    }
+    const uint_fast8_t next = (capture.head + 1U) & CAPTURE_RING_MASK;
+    if (next == capture.tail) {
+        if (state == CAPTURE_RUNNING) {
+            capture.lost++;
+            return;
+        }
+        capture.tail = (capture.tail + 1U) & CAPTURE_RING_MASK;
+        if (state == CAPTURE_TRIGGERED && capture.pre) {
+            capture.pre--;
+        }
+    }
+    capture.count[capture.head] = count;
+    if (active) {
+        capture.active |= (1UL << capture.head);
+    } else {
+        capture.active &= ~(1UL << capture.head);
+    }
+    capture.head = next;
+    if (state == CAPTURE_TRIGGERED && --capture.post == 0) {
+        capture.state = CAPTURE_FROZEN;
+    }
+}
+
+static void print_start(uint32_t time, bool active)
+{
+    uint8_t result[CAPTURE_START_MESSAGE_SIZE];
+    result[0] = CAPTURE_START;
+    serial_put_uint32(&result[1], time);
+    result[5] = active;
+    serial_print_block(SERIAL_REPORT_EDGE_CAPTURE, result, sizeof(result));
+}
+
+void capture_start(void)
+{
+    taskENTER_CRITICAL();
+    capture.head = 0;
+    capture.tail = 0;
+    capture.lost = 0;
+    capture.edges = 0;
+    capture.lost_total = 0;
+    capture.last_count = dali_101_get_time();
+    capture.state = CAPTURE_RUNNING;
+    const uint32_t time = capture.last_count;
+    const bool active = (board_dali_rx_pin() == DALI_RX_ACTIVE);
+    taskEXIT_CRITICAL();
+    print_start(time, active);
+}
+
+void capture_arm(const struct capture_trigger* trigger)
+{
+    taskENTER_CRITICAL();
+    capture.head = 0;
+    capture.tail = 0;
+    capture.lost = 0;
+    capture.edges = 0;
+    capture.lost_total = 0;
+    capture.trigger = *trigger;
+    capture.state = CAPTURE_ARMED;
+    taskEXIT_CRITICAL();
+}
+
+// must be called inside a critical section
+static void fire_trigger(void)
+{
+    capture.trigger_time = dali_101_get_time();
+    capture.pre = (capture.head - capture.tail) & CAPTURE_RING_MASK;
+    capture.post = capture.trigger.post;
+    capture.state = capture.post ? CAPTURE_TRIGGERED : CAPTURE_FROZEN;
+}
+
+void capture_stop(void)
+{
+    taskENTER_CRITICAL();
+    if (capture.state == CAPTURE_RUNNING) {
+        capture.state = CAPTURE_STOPPING;
+    } else if (capture.state == CAPTURE_ARMED) {
+        fire_trigger();
+        capture.state = CAPTURE_FROZEN;
+    } else if (capture.state == CAPTURE_TRIGGERED) {
+        capture.state = CAPTURE_FROZEN;
+    }
+    taskEXIT_CRITICAL();
+}
+
+void capture_check(const struct dali_rx_frame* frame)
+{
+    if (capture.state != CAPTURE_ARMED) {
+        return;
+    }
+    const bool match = capture.trigger.status ? (frame->status == capture.trigger.status)
+                                              : filter_is_match(&capture.trigger.rule, frame);
+    if (match) {
+        taskENTER_CRITICAL();
+        if (capture.state == CAPTURE_ARMED) {
+            fire_trigger();
+        }
+        taskEXIT_CRITICAL();
+    }
+}
+
+// unsigned LEB128, 7 bits per byte, least significant group first
+static size_t put_varint(uint8_t* buffer, uint64_t value)
+{
+    size_t length = 0;
+    while (value > CAPTURE_VARINT_MASK) {
+        buffer[length++] = (value & CAPTURE_VARINT_MASK) | CAPTURE_VARINT_MORE;
+        value >>= 7U;
+    }
+    buffer[length++] = value;
+    return length;
+}
+
+static void print_counter(enum capture_kind kind, uint32_t first, uint32_t second)
+{
+    uint8_t result[CAPTURE_COUNTER_MESSAGE_SIZE];
+    result[0] = kind;
+    serial_put_uint32(&result[1], first);
+    serial_put_uint32(&result[5], second);
+    serial_print_block(SERIAL_REPORT_EDGE_CAPTURE, result, sizeof(result));
+}
+
+// each edge is the time since the previous edge with the bus level in bit 0
+static void print_edges(uint_fast8_t head)
+{
+    while (capture.tail != head) {
+        uint8_t result[CAPTURE_EDGE_MESSAGE_SIZE];
+        size_t length = 0;
+        result[length++] = CAPTURE_EDGES;
+        for (uint_fast8_t i = 0; i < CAPTURE_EDGES_PER_MESSAGE && capture.tail != head; i++) {
+            const uint32_t count = capture.count[capture.tail];
+            const bool active = (capture.active >> capture.tail) & 1U;
+            length += put_varint(&result[length], ((uint64_t)(count - capture.last_count) << 1U) | active);
+            capture.last_count = count;
+            capture.edges++;
+            capture.tail = (capture.tail + 1U) & CAPTURE_RING_MASK;
+        }
+        serial_print_block(SERIAL_REPORT_EDGE_CAPTURE, result, length);
+    }
+}
+
+// the start message carries the oldest edge, the following edges are relative to it
+static void print_frozen(void)
+{
+    if (capture.tail == capture.head) {
+        print_start(capture.trigger_time, board_dali_rx_pin() == DALI_RX_ACTIVE);
+    } else {
+        capture.last_count = capture.count[capture.tail];
+        print_start(capture.last_count, (capture.active >> capture.tail) & 1U);
+        capture.edges++;
+        capture.tail = (capture.tail + 1U) & CAPTURE_RING_MASK;
+    }
+    print_counter(CAPTURE_TRIGGER, capture.pre, capture.trigger_time);
+    print_edges(capture.head);
+    capture.state = CAPTURE_OFF;
+    print_counter(CAPTURE_STOP, capture.edges, capture.lost_total);
+}
+
+void capture_run(void)
+{
+    const enum capture_state state = capture.state;
+    if (state == CAPTURE_FROZEN) {
+        print_frozen();
+        return;
+    }
+    if (state != CAPTURE_RUNNING && state != CAPTURE_STOPPING) {
+        return;
+    }
+    // all edges in the ring were recorded before the ones that got lost
+    taskENTER_CRITICAL();
+    const uint_fast8_t head = capture.head;
+    const uint32_t lost = capture.lost;
+    capture.lost = 0;
+    const bool stopping = (capture.state == CAPTURE_STOPPING);
+    taskEXIT_CRITICAL();
+    print_edges(head);
+    if (lost) {
+        capture.lost_total += lost;
+        print_counter(CAPTURE_LOST, lost, capture.lost_total);
+    }
+    if (stopping) {
+        capture.state = CAPTURE_OFF;
+        print_counter(CAPTURE_STOP, capture.edges, capture.lost_total);
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <stdbool.h>               // for bool
+#include <stdint.h>                // for uint8_t, uint32_t
+#include "dali_101_lpc/dali_101.h" // for dali_rx_frame
+#include "filter.h"                // for filter_rule
+
+#define CAPTURE_RING_SIZE (32U)
+#define CAPTURE_MAX_POST_EDGES (CAPTURE_RING_SIZE - 1U)
+
+/**
+ * @brief Condition that freezes an armed capture
+ *
+ */
+struct capture_trigger {
+    uint8_t post;            /**< number of edges recorded after the trigger */
+    uint8_t status;          /**< trigger on frames with this status code, 0 - use the rule */
+    struct filter_rule rule; /**< trigger on frames that match the rule */
+};
+
+/**
+ * @brief Start streaming the captured edges, discards edges not yet output
+ *
+ */
+void capture_start(void);
+
+/**
+ * @brief Stop streaming the captured edges, the edges already recorded are still output.
+ *        An armed capture is triggered right away.
+ *
+ */
+void capture_stop(void);
+
+/**
+ * @brief Keep the latest edges in the ring until the trigger condition is met,
+ *        then output the edges before and after the trigger
+ *
+ * @param trigger trigger condition
+ */
+void capture_arm(const struct capture_trigger* trigger);
+
+/**
+ * @brief Check a received frame against the trigger condition. Must be called from the main task.
+ *
+ * @param frame received frame
+ */
+void capture_check(const struct dali_rx_frame* frame);
+
+/**
+ * @brief Record a captured edge, see `dali_101_edge_recorder`
+ *
+ * @param count capture count of the edge
+ * @param active `true` - bus is active (low) after the edge
+ */
+void capture_record(uint32_t count, bool active);
+
+/**
+ * @brief Output the recorded edges with block messages. Must be called from the main task.
+ *
+ */
+void capture_run(void);
@@ -0,0 +1,194 @@
+#include <stdbool.h> // for bool, false, true
+#include <stddef.h>  // for NULL
+#include <stdint.h>  // for uint8_t, uint32_t, uint64_t, uint_fast8_t
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "dali_101_lpc/dali_101.h"
+#include "bus.h"
+#include "serial.h"
+#include "commission.h"
+
+#define COMMISSION_ADDRESSES (64U)
+#define COMMISSION_RETRIES (3U)
+#define COMMISSION_RANDOMISE_MS (100U)
+#define COMMISSION_SEARCH_MAX (0xFFFFFFUL)
+#define COMMISSION_ALL_DEVICES (0x00U)
+#define COMMISSION_UNADDRESSED_DEVICES (0xFFU)
+#define COMMISSION_DELETE_ADDRESS (0xFFU)
+#define COMMISSION_YES (0xFFU)
+
+// see IEC 62386-102:2014 Table 16 - Special commands
+#define DALI_TERMINATE (0xA100U)
+#define DALI_INITIALISE (0xA500U)
+#define DALI_RANDOMISE (0xA700U)
+#define DALI_COMPARE (0xA900U)
+#define DALI_WITHDRAW (0xAB00U)
+#define DALI_SEARCHADDRH (0xB100U)
+#define DALI_SEARCHADDRM (0xB300U)
+#define DALI_SEARCHADDRL (0xB500U)
+#define DALI_PROGRAM_SHORT_ADDRESS (0xB700U)
+#define DALI_QUERY_SHORT_ADDRESS (0xBB00U)
+
+enum commission_status {
+    COMMISSION_OK = 0,
+    COMMISSION_BUS_ERROR,
+    COMMISSION_NO_ADDRESS_LEFT,
+    COMMISSION_UNRESOLVED,
+};
+
+enum answer { ANSWER_NONE, ANSWER_YES, ANSWER_COLLISION };
+
+static struct _commission {
+    enum dali_frame_type forward_type;
+    enum dali_frame_type query_type;
+    uint32_t search_address;
+    bool search_address_valid;
+    bool bus_error;
+} commission;
+
+static uint8_t short_address_data(uint8_t short_address)
+{
+    return (short_address << 1U) | 1U;
+}
+
+static void send_command(uint16_t data, bool twice)
+{
+    if (commission.bus_error) {
+        return;
+    }
+    const struct dali_tx_frame frame = { .type = commission.forward_type, .length = 16, .data = data, .repeat = twice };
+    if (!bus_send(frame, NULL)) {
+        commission.bus_error = true;
+    }
+}
+
+static enum answer query_command(uint16_t data, uint8_t expected)
+{
+    if (commission.bus_error) {
+        return ANSWER_NONE;
+    }
+    const struct dali_tx_frame frame = { .type = commission.query_type, .length = 16, .data = data };
+    struct dali_rx_frame reply;
+    if (!bus_query(frame, &reply)) {
+        commission.bus_error = true;
+        return ANSWER_NONE;
+    }
+    if (reply.status == DALI_TIMEOUT) {
+        return ANSWER_NONE;
+    }
+    if (reply.status == DALI_OK && reply.length == 8 && reply.data == expected) {
+        return ANSWER_YES;
+    }
+    return ANSWER_COLLISION;
+}
+
+static void set_search_address(uint32_t search_address)
+{
+    static const uint16_t command[] = { DALI_SEARCHADDRH, DALI_SEARCHADDRM, DALI_SEARCHADDRL };
+    for (uint_fast8_t i = 0; i < 3; i++) {
+        const uint_fast8_t shift = 8U * (2U - i);
+        const uint8_t value = search_address >> shift;
+        if (commission.search_address_valid && (value == (uint8_t)(commission.search_address >> shift))) {
+            continue;
+        }
+        send_command(command[i] | value, false);
+    }
+    commission.search_address = search_address;
+    commission.search_address_valid = !commission.bus_error;
+}
+
+// any reply to COMPARE counts, several devices answering at once corrupt the backframe
+static bool compare(uint32_t search_address)
+{
+    set_search_address(search_address);
+    return (query_command(DALI_COMPARE, COMMISSION_YES) != ANSWER_NONE);
+}
+
+static bool find_lowest_random_address(uint32_t* random_address)
+{
+    if (!compare(COMMISSION_SEARCH_MAX)) {
+        return false;
+    }
+    uint32_t low = 0;
+    uint32_t high = COMMISSION_SEARCH_MAX;
+    while (low < high && !commission.bus_error) {
+        const uint32_t middle = low + ((high - low) / 2U);
+        if (compare(middle)) {
+            high = middle;
+        } else {
+            low = middle + 1U;
+        }
+    }
+    set_search_address(low);
+    *random_address = low;
+    return !commission.bus_error;
+}
+
+static void randomise(void)
+{
+    send_command(DALI_RANDOMISE, true);
+    vTaskDelay(pdMS_TO_TICKS(COMMISSION_RANDOMISE_MS));
+    commission.search_address_valid = false;
+}
+
+static void report_device(uint8_t short_address, uint32_t random_address)
+{
+    const uint8_t result[] = { short_address, random_address >> 16U, random_address >> 8U, random_address };
+    serial_print_block(SERIAL_REPORT_COMMISSION_DEVICE, result, sizeof(result));
+}
+
+static void report_done(enum commission_status status, uint8_t count, uint64_t assigned)
+{
+    uint8_t result[2 + SERIAL_BITMAP_SIZE] = { status, count };
+    serial_put_bitmap(&result[2], assigned);
+    serial_print_block(SERIAL_REPORT_COMMISSION_DONE, result, sizeof(result));
+}
+
+void commission_execute(const struct commission_request* request)
+{
+    commission = (struct _commission){ .forward_type = request->forward_type, .query_type = request->query_type };
+    enum commission_status status = COMMISSION_OK;
+    uint8_t short_address = request->first_address;
+    uint8_t count = 0;
+    uint64_t assigned = 0;
+    uint_fast8_t retries = 0;
+
+    send_command(DALI_INITIALISE | (request->unaddressed_only ? COMMISSION_UNADDRESSED_DEVICES : COMMISSION_ALL_DEVICES),
+                 true);
+    randomise();
+    while (status == COMMISSION_OK) {
+        uint32_t random_address;
+        if (!find_lowest_random_address(&random_address)) {
+            break;
+        }
+        if (short_address >= COMMISSION_ADDRESSES) {
+            status = COMMISSION_NO_ADDRESS_LEFT;
+            break;
+        }
+        send_command(DALI_PROGRAM_SHORT_ADDRESS | short_address_data(short_address), false);
+        // only the selected device answers, VERIFY SHORT ADDRESS would be answered by every
+        // initialised device that already has the short address
+        const enum answer confirm = query_command(DALI_QUERY_SHORT_ADDRESS, short_address_data(short_address));
+        if (confirm == ANSWER_YES) {
+            send_command(DALI_WITHDRAW, false);
+            report_device(short_address, random_address);
+            assigned |= ((uint64_t)1 << short_address);
+            short_address++;
+            count++;
+            retries = 0;
+        } else if (retries++ < COMMISSION_RETRIES) {
+            // devices share the random address, give them a new one
+            send_command(DALI_PROGRAM_SHORT_ADDRESS | COMMISSION_DELETE_ADDRESS, false);
+            randomise();
+        } else {
+            status = COMMISSION_UNRESOLVED;
+        }
+    }
+    send_command(DALI_TERMINATE, false);
+    if (commission.bus_error) {
+        status = COMMISSION_BUS_ERROR;
+    }
+    report_done(status, count, assigned);
+}
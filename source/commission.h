@@ -0,0 +1,22 @@
+#pragma once
+#include <stdbool.h>               // for bool
+#include <stdint.h>                // for uint8_t
+#include "dali_101_lpc/dali_101.h" // for dali_frame_type
+
+/**
+ * @brief Parameters for the random address search
+ *
+ */
+struct commission_request {
+    enum dali_frame_type forward_type; /**< frame type used for commands */
+    enum dali_frame_type query_type;   /**< frame type used for queries */
+    uint8_t first_address;             /**< short address assigned to the first device found */
+    bool unaddressed_only;             /**< only commission devices without short address */
+};
+
+/**
+ * @brief Search all devices by their random address and program short addresses
+ *
+ * @param request commissioning parameters
+ */
+void commission_execute(const struct commission_request* request);
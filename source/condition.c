@@ -0,0 +1,61 @@
+#include <stdbool.h> // for bool, false, true
+#include <stddef.h>  // for NULL
+#include <stdint.h>  // for uint8_t
+
+#include "dali_101_lpc/dali_101.h"
+#include "bus.h"
+#include "serial.h"
+#include "condition.h"
+
+enum condition_sent {
+    CONDITION_NOTHING_SENT = 0,
+    CONDITION_SENT,
+    CONDITION_BUS_ERROR,
+};
+
+// reported when the query failed and no branch was taken
+#define CONDITION_NO_BRANCH (0xFFU)
+
+static bool is_match(const struct condition_request* request, const struct dali_rx_frame* reply)
+{
+    if (reply->status != DALI_OK || reply->length != 8) {
+        return false;
+    }
+    return ((reply->data ^ request->value) & request->mask) == 0;
+}
+
+static enum condition_sent send_conditional_frame(const struct condition_request* request,
+                                                  const struct condition_frame* frame)
+{
+    if (frame->length == 0) {
+        return CONDITION_NOTHING_SENT;
+    }
+    const struct dali_tx_frame tx_frame = {
+        .type = request->forward_type, .length = frame->length, .data = frame->data, .repeat = frame->twice
+    };
+    return bus_send(tx_frame, NULL) ? CONDITION_SENT : CONDITION_BUS_ERROR;
+}
+
+static void report_result(const struct dali_rx_frame* reply, uint8_t branch, enum condition_sent sent)
+{
+    uint8_t result[7] = { (reply->status > DALI_OK) ? reply->status : reply->length };
+    serial_put_uint32(&result[1], reply->data);
+    result[5] = branch;
+    result[6] = sent;
+    serial_print_block(SERIAL_REPORT_CONDITION, result, sizeof(result));
+}
+
+void condition_execute(const struct condition_request* request)
+{
+    const struct dali_tx_frame query = { .type = request->query_type,
+                                         .length = request->query_length,
+                                         .data = request->query_data };
+    struct dali_rx_frame reply;
+    if (!bus_query(query, &reply)) {
+        const struct dali_rx_frame failed = { .status = DALI_ERROR_CAN_NOT_PROCESS };
+        report_result(&failed, CONDITION_NO_BRANCH, CONDITION_BUS_ERROR);
+        return;
+    }
+    const enum condition_branch branch = is_match(request, &reply) ? CONDITION_MATCH : CONDITION_NO_MATCH;
+    report_result(&reply, branch, send_conditional_frame(request, &request->frame[branch]));
+}
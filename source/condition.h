@@ -0,0 +1,37 @@
+#pragma once
+#include <stdbool.h>               // for bool
+#include <stdint.h>                // for uint8_t, uint32_t
+#include "dali_101_lpc/dali_101.h" // for dali_frame_type
+
+enum condition_branch { CONDITION_MATCH = 0, CONDITION_NO_MATCH, CONDITION_BRANCHES };
+
+/**
+ * @brief Frame sent depending on the reply
+ *
+ */
+struct condition_frame {
+    uint32_t data;  /**< data payload */
+    uint8_t length; /**< number of data bits, 0 - send nothing */
+    bool twice;     /**< send frame twice */
+};
+
+/**
+ * @brief Parameters for a conditional transmission
+ *
+ */
+struct condition_request {
+    enum dali_frame_type query_type;                   /**< frame type used for the query */
+    enum dali_frame_type forward_type;                 /**< frame type used for the conditional frame */
+    uint32_t query_data;                               /**< query data payload */
+    uint8_t query_length;                              /**< number of query data bits */
+    uint8_t value;                                     /**< expected backframe value */
+    uint8_t mask;                                      /**< bits of the backframe to compare */
+    struct condition_frame frame[CONDITION_BRANCHES];  /**< frames for match and no match */
+};
+
+/**
+ * @brief Send a query and send a frame depending on the reply. Must be called from the main task.
+ *
+ * @param request conditional transmission parameters
+ */
+void condition_execute(const struct condition_request* request);
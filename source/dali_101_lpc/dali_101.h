@@ -60,6 +60,89 @@ struct dali_rx_frame {
     uint8_t length;          /**< number of data bits received */
     uint32_t data;           /**< data payload */
     uint32_t timestamp;      /**< timetstamp when start bit was deteceted */
+    uint32_t time_us;        /**< device time in microseconds when start bit was detected, see `dali_101_get_time` */
+};
+
+/**
+ * @brief Condition to start an armed frame
+ *
+ */
+struct dali_trigger {
+    uint32_t delay_us;     /**< delay from the foreign start bit to the start of the frame */
+    uint32_t prefix;       /**< expected leading data bits */
+    uint8_t prefix_length; /**< number of leading data bits to compare, 0 - every start bit triggers */
+};
+
+/**
+ * @brief Accumulated time the bus spent in each condition
+ *
+ */
+struct dali_bus_time {
+    uint32_t idle_us;     /**< no frame on the bus */
+    uint32_t foreign_us;  /**< frames of other bus participants */
+    uint32_t transmit_us; /**< frames sent by the interface */
+    uint32_t failure_us;  /**< bus is low or in failure state */
+};
+
+/**
+ * @brief Frames used to measure the bus phases
+ *
+ */
+enum dali_measure {
+    DALI_MEASURE_OFF = 0,  /**< no measurement */
+    DALI_MEASURE_LOOPBACK, /**< frames sent by the interface */
+    DALI_MEASURE_FOREIGN,  /**< frames of other bus participants */
+};
+
+enum dali_phase { DALI_PHASE_IDLE = 0, DALI_PHASE_ACTIVE, DALI_PHASES };
+
+#define DALI_PRIORITIES (5U)
+
+/**
+ * @brief Settling times before a frame is sent, see IEC 62386-101:2022 Table 22.
+ * Backward frames start after the end of the last forward frame, all other frames
+ * after the last edge on the bus.
+ */
+struct dali_settling_times {
+    uint32_t backward_us;                  /**< backward frame, 5500..10500 */
+    uint32_t forward_us[DALI_PRIORITIES];  /**< forward frames of priority 1..5, each within 10500 and the
+                                                upper limit of its priority window, not decreasing */
+    uint32_t back_to_back_us;              /**< frames sent back to back, 2400..5500 */
+    uint32_t min_slack_us;                 /**< shortest lead of a scheduled start, 10..1000 */
+};
+
+/**
+ * @brief Delays of the frames started by the transmit timer at the end of the settling time,
+ * from the scheduled start to the first edge seen by the receiver
+ *
+ */
+struct dali_start_statistics {
+    uint32_t count;       /**< number of frames measured */
+    int32_t delay_sum_us; /**< sum of the delays in microseconds */
+    int32_t delay_min_us; /**< shortest delay in microseconds */
+    int32_t delay_max_us; /**< longest delay in microseconds */
+};
+
+/**
+ * @brief Predefined settling times
+ *
+ */
+enum dali_settling_profile {
+    DALI_SETTLING_MULTI_MASTER = 0, /**< lower limits of the priority windows, the default */
+    DALI_SETTLING_SINGLE_MASTER,    /**< forward frames after the longest backward frame settling time */
+    DALI_SETTLING_PROFILES,
+};
+
+/**
+ * @brief Measured durations of the bus phases inside frames, as captured without correction
+ *
+ */
+struct dali_phase_statistics {
+    uint32_t count[DALI_PHASES];    /**< number of phases measured */
+    int32_t error_sum[DALI_PHASES]; /**< sum of the deviations from the nominal half bit or full bit
+                                         in 1/3 microseconds */
+    int32_t error_min[DALI_PHASES]; /**< smallest deviation in 1/3 microseconds */
+    int32_t error_max[DALI_PHASES]; /**< largest deviation in 1/3 microseconds */
 };
 
 /**
@@ -71,8 +154,44 @@ struct dali_tx_frame {
     uint32_t data;             /**< data payload */
     uint8_t repeat;            /**< repeat entire frame */
     enum dali_frame_type type; /**< frame type */
+    bool sequence;             /**< send the defined bit sequence, length and data are ignored */
 };
 
+/**
+ * @brief Decide on an automatic backward frame for a received forward frame
+ *
+ * Called by the receiver task right after a foreign frame was received without error.
+ * The function must not block.
+ *
+ * @param frame received frame
+ * @param reply frame to send, preset as backward frame, set `data`, or change `type` to
+ *              `DALI_FRAME_CORRUPT` to send a corrupt backward frame
+ * @param delay_us time from the last edge of the received frame to the start of the
+ *                 reply in micro seconds, leave 0 for the default settling time
+ * @return `true` - send the reply
+ * @return `false` - do not respond
+ */
+typedef bool (*dali_101_responder)(const struct dali_rx_frame* frame, struct dali_tx_frame* reply, uint32_t* delay_us);
+
+/**
+ * @brief Observe every frame that is put into the input queue
+ *
+ * Mostly called by the receiver task, the function must not block.
+ *
+ * @param frame received frame, including error and timeout frames
+ */
+typedef void (*dali_101_observer)(const struct dali_rx_frame* frame);
+
+/**
+ * @brief Record every edge captured by the receiver timer
+ *
+ * Called from the capture interrupt, the function must be short.
+ *
+ * @param count capture count of the edge, device time in microseconds
+ * @param active `true` - bus is active (low) after the edge
+ */
+typedef void (*dali_101_edge_recorder)(uint32_t count, bool active);
+
 /**
  * @brief Initialize the DALI low level driver.
  *
@@ -86,6 +205,53 @@ void dali_101_init(void);
  */
 void dali_101_send(const struct dali_tx_frame frame);
 
+/**
+ * @brief Send DALI frame at a device time
+ *
+ * The frame starts at `time_us`, or as soon as the settling times allow. The transmitter
+ * is busy until the frame is sent. A time that has passed starts the frame at once.
+ *
+ * @param frame frame to send
+ * @param time_us device time in microseconds, see `dali_101_get_time`
+ */
+void dali_101_send_at(const struct dali_tx_frame frame, uint32_t time_us);
+
+/**
+ * @brief Send DALI frame a delay after the start bit of a frame of another bus participant
+ *
+ * The frame starts when the delay has passed, settling times do not apply. With a prefix
+ * the received frame must start with these data bits; when they are received after the
+ * delay, the frame starts right away. The transmitter is busy until the frame is sent.
+ *
+ * @param frame frame to send
+ * @param trigger trigger condition
+ */
+void dali_101_send_triggered(const struct dali_tx_frame frame, const struct dali_trigger* trigger);
+
+/**
+ * @brief Get the device time, the time base of the receiver
+ *
+ * @return time in microseconds, wraps around after 2^32 microseconds
+ */
+uint32_t dali_101_get_time(void);
+
+/**
+ * @brief Check if the receiver waits for a frame, no frame is on the bus and the bus is not in failure state
+ *
+ * @return `true` - receiver is idle
+ * @return `false` - a frame or a failure is on the bus
+ */
+bool dali_101_rx_is_idle(void);
+
+/**
+ * @brief Cancel the remaining repetitions of the current frame, and a frame waiting for its start time
+ *
+ * A frame on the bus is completed, only frames that did not start are discarded.
+ *
+ * @return number of discarded frames
+ */
+uint8_t dali_101_cancel_repeat(void);
+
 /**
  * @brief Get the next frame from the input queue.
  *
@@ -98,16 +264,132 @@ void dali_101_send(const struct dali_tx_frame frame);
 bool dali_101_get(struct dali_rx_frame* frame, uint32_t wait_ms, bool forever);
 
 /**
- * @brief Check if a transmission is active or pending
+ * @brief Check if a transmission is active or pending, a frame that waits for the bus is pending
  *
  * @return `true` - no transmission
  * @return `false` - transmission is active
  */
 bool dali_101_tx_is_idle(void);
 
+/**
+ * @brief Check if a frame of the interface is on the bus, an active frame must not be replaced
+ *
+ * @return `true` - frame is on the bus or starts from the timer
+ * @return `false` - no frame on the bus, a pending frame waits for the bus
+ */
+bool dali_101_tx_is_sending(void);
+
+/**
+ * @brief Install the function that observes received frames
+ *
+ * @param observer observer function, `NULL` disables the observation
+ */
+void dali_101_set_observer(dali_101_observer observer);
+
+/**
+ * @brief Install the function that records captured edges
+ *
+ * @param recorder recorder function, `NULL` disables the recording
+ */
+void dali_101_set_edge_recorder(dali_101_edge_recorder recorder);
+
+/**
+ * @brief Restart the measurement of the bus phases
+ *
+ * @param source frames to measure, `DALI_MEASURE_OFF` stops the measurement
+ */
+void dali_101_measure_phases(enum dali_measure source);
+
+/**
+ * @brief Get the measured bus phases since the measurement was started
+ *
+ * @param statistics measured phases
+ */
+void dali_101_get_phase_statistics(struct dali_phase_statistics* statistics);
+
+/**
+ * @brief Set the correction of the receiver for the different delays of falling and rising edges
+ *
+ * Active phases are extended, idle phases are shortened by the asymmetry.
+ *
+ * @param asymmetry_us delay of the falling edge minus delay of the rising edge in microseconds
+ */
+void dali_101_set_rx_asymmetry(int32_t asymmetry_us);
+
+/**
+ * @brief Get the correction of the receiver for the different delays of falling and rising edges
+ *
+ * @return delay of the falling edge minus delay of the rising edge in microseconds
+ */
+int32_t dali_101_get_rx_asymmetry(void);
+
+/**
+ * @brief Set the correction of the transmitter for the phases of one level
+ *
+ * @param phase level of the phases
+ * @param compensation_us time added to the nominal duration of the phases in microseconds
+ */
+void dali_101_set_tx_compensation(enum dali_phase phase, int32_t compensation_us);
+
+/**
+ * @brief Get the correction of the transmitter for the phases of one level
+ *
+ * @param phase level of the phases
+ * @return time added to the nominal duration of the phases in microseconds
+ */
+int32_t dali_101_get_tx_compensation(enum dali_phase phase);
+
+/**
+ * @brief Set the settling times, the settling times are kept if one of them is out of range
+ *
+ * @param times settling times in microseconds
+ * @return true - settling times are set, false - out of range
+ */
+bool dali_101_set_settling_times(const struct dali_settling_times* times);
+
+/**
+ * @brief Set the settling times of a profile
+ *
+ * @param profile predefined settling times
+ */
+void dali_101_set_settling_profile(enum dali_settling_profile profile);
+
+/**
+ * @brief Get the settling times in use
+ *
+ * @param times settling times in microseconds
+ */
+void dali_101_get_settling_times(struct dali_settling_times* times);
+
+/**
+ * @brief Get the delays of the scheduled frame starts, the jitter is the longest minus the shortest delay
+ *
+ * @param statistics measured delays
+ * @param reset `true` - restart the measurement
+ */
+void dali_101_get_start_statistics(struct dali_start_statistics* statistics, bool reset);
+
+/**
+ * @brief Get the accumulated bus time and restart the accumulation
+ *
+ * The accumulation uses the 32 bit receive timer, call this function
+ * at least once per hour.
+ *
+ * @param time time spent in each condition since the last call
+ */
+void dali_101_get_bus_time(struct dali_bus_time* time);
+
+/**
+ * @brief Install the function that answers received forward frames
+ *
+ * @param responder responder function, `NULL` disables automatic responses
+ */
+void dali_101_set_responder(dali_101_responder responder);
+
 /**
  * @brief Start a new bit sequence, discard old sequence information
  *
+ * The sequence is sent with `dali_101_send` and a frame that has `sequence` set.
  */
 void dali_101_sequence_start(void);
 
@@ -118,12 +400,6 @@ void dali_101_sequence_start(void);
  */
 void dali_101_sequence_next(uint32_t period_us);
 
-/**
- * @brief Send the sequence
- *
- */
-void dali_101_sequence_execute(void);
-
 /* callback functions defined by the low level driver
  *  to be called by the board interface module
  */
@@ -132,3 +408,4 @@ void dali_rx_irq_capture_callback(void);
 void dali_rx_irq_stopbit_match_callback(void);
 void dali_rx_irq_period_match_callback(void);
 void dali_rx_irq_query_match_callback(void);
+void dali_rx_irq_start_match_callback(void);
@@ -16,8 +16,17 @@
 #define NOTIFY_MATCH (0x02)
 #define NOTIFY_PRIORITY (0x04)
 #define NOTIFY_QUERY (0x08)
+#define NOTIFY_START (0x10)
 
 #define QUEUE_SIZE (5U)
+// phases up to this duration are half bits, longer ones full bits
+#define MEASURE_FULL_BIT_LIMIT_US (625U)
+#define MEASURE_MAX_PHASE_US (1100U)
+// nominal phase durations in 1/3 microseconds
+#define MEASURE_HALF_BIT_THIRDS (1250)
+#define MEASURE_FULL_BIT_THIRDS (2500)
+
+enum trigger_state { TRIGGER_OFF = 0, TRIGGER_ARMED, TRIGGER_PREFIX, TRIGGER_FIRED };
 
 enum rx_status {
     IDLE = 0,
@@ -58,17 +67,67 @@ static const struct _rx_timing {
     .max_receive_twice_delay_ms = 95,   // Table 20
 };
 
+// see IEC 62386-101-2022 Table 22 - Multi-master transmitter settling time values
+// on a single-master bus no other transmitter arbitrates, forward frames only wait for a backward frame
+static const struct dali_settling_times settling_profiles[DALI_SETTLING_PROFILES] = {
+    [DALI_SETTLING_MULTI_MASTER] = { .backward_us = 5500,
+                                     .forward_us = { 13500, 14900, 16300, 17900, 19500 },
+                                     .back_to_back_us = 2450,
+                                     .min_slack_us = 100 },
+    [DALI_SETTLING_SINGLE_MASTER] = { .backward_us = 5500,
+                                      .forward_us = { 11000, 11000, 11000, 11000, 11000 },
+                                      .back_to_back_us = 2450,
+                                      .min_slack_us = 100 },
+};
+
+static const struct _settling_limits {
+    uint32_t min_backward_us;
+    uint32_t max_backward_us;
+    uint32_t min_forward_us;
+    uint32_t max_forward_us[DALI_PRIORITIES];
+    uint32_t min_back_to_back_us;
+    uint32_t max_back_to_back_us;
+    uint32_t min_slack_us;
+    uint32_t max_slack_us;
+} settling_limits = {
+    .min_backward_us = 5500, // Table 22
+    .max_backward_us = 10500,
+    .min_forward_us = 10500, // latest start of a backward frame, Table 22
+    .max_forward_us = { 14700, 16100, 17700, 19300, 21100 },
+    .min_back_to_back_us = 2400,
+    .max_back_to_back_us = 5500,
+    .min_slack_us = 10,
+    .max_slack_us = 1000,
+};
+
 // module variables
 struct _rx {
     uint32_t last_edge_count;
     uint32_t last_full_frame_count;
     uint32_t edge_count;
     uint32_t end_inter_frame_idle;
+    uint32_t scheduled_start;
+    bool start_is_scheduled;
+    struct dali_start_statistics start;
     enum rx_status status;
     struct dali_rx_frame frame;
     bool last_data_bit;
     bool transmission_is_waiting;
     enum dali_frame_type transmission_frame_type;
+    enum dali_frame_type armed_frame_type;
+    struct dali_trigger trigger;
+    enum trigger_state trigger_state;
+    uint32_t trigger_start_count;
+    dali_101_responder responder;
+    dali_101_observer observer;
+    dali_101_edge_recorder edge_recorder;
+    uint32_t response_delay_us;
+    uint32_t last_account_count;
+    struct dali_bus_time bus_time;
+    int32_t asymmetry_us;
+    struct dali_settling_times settling;
+    enum dali_measure measure;
+    struct dali_phase_statistics phases;
     TaskHandle_t task_handle;
     QueueHandle_t queue_handle;
 } rx = { 0 };
@@ -76,8 +135,11 @@ struct _rx {
 // external references from tx module
 extern void dali_tx_init(void);
 extern void dali_tx_start_send(void);
+extern void dali_tx_schedule_send(uint32_t delay_us);
+extern bool dali_tx_cancel_scheduled(void);
 extern uint32_t tx_get_settling_time(void);
 extern bool dali_tx_repeat(void);
+extern bool dali_tx_release(void);
 extern void tx_reset(void);
 
 void dali_rx_irq_capture_callback(void)
@@ -85,6 +147,14 @@ void dali_rx_irq_capture_callback(void)
     BaseType_t higher_priority_woken = pdFALSE;
 
     rx.edge_count = board_dali_rx_get_capture();
+    // another device started a frame before the scheduled one, it waits for the next settling time
+    if (rx.start_is_scheduled && (int32_t)(rx.edge_count - rx.scheduled_start) < 0) {
+        dali_tx_cancel_scheduled();
+        rx.start_is_scheduled = false;
+    }
+    if (rx.edge_recorder) {
+        rx.edge_recorder(rx.edge_count, board_dali_rx_pin());
+    }
     board_dali_rx_set_stopbit_match(rx.edge_count + rx_timing.min_stop_condition_us);
     board_dali_rx_stopbit_match_enable(true);
     xTaskNotifyFromISR(rx.task_handle, NOTIFY_CAPTURE, eSetBits, &higher_priority_woken);
@@ -107,6 +177,22 @@ void dali_rx_irq_period_match_callback(void)
     portYIELD_FROM_ISR(higher_priority_woken);
 }
 
+void dali_rx_irq_start_match_callback(void)
+{
+    board_dali_rx_start_match_enable(false);
+    // a triggered frame starts right here, the receiver task would add jitter
+    if (rx.trigger_state == TRIGGER_FIRED) {
+        rx.trigger_state = TRIGGER_OFF;
+        if (dali_tx_release()) {
+            dali_tx_start_send();
+        }
+        return;
+    }
+    BaseType_t higher_priority_woken = pdFALSE;
+    xTaskNotifyFromISR(rx.task_handle, NOTIFY_START, eSetBits, &higher_priority_woken);
+    portYIELD_FROM_ISR(higher_priority_woken);
+}
+
 void dali_rx_irq_query_match_callback(void)
 {
     BaseType_t higher_priority_woken = pdFALSE;
@@ -117,27 +203,26 @@ void dali_rx_irq_query_match_callback(void)
 
 static uint32_t get_settling_time_us(enum dali_frame_type type)
 {
-    static const uint32_t settling_time_us[] = { 5500, 13500, 14900, 16300, 17900, 19500, 2450 };
     switch (type) {
     case DALI_FRAME_BACKWARD:
-        return settling_time_us[0];
+        return rx.settling.backward_us;
     case DALI_FRAME_FORWARD_1:
     case DALI_FRAME_QUERY_1:
-        return settling_time_us[1];
+        return rx.settling.forward_us[0];
     case DALI_FRAME_FORWARD_2:
     case DALI_FRAME_QUERY_2:
-        return settling_time_us[2];
+        return rx.settling.forward_us[1];
     case DALI_FRAME_FORWARD_3:
     case DALI_FRAME_QUERY_3:
-        return settling_time_us[3];
+        return rx.settling.forward_us[2];
     case DALI_FRAME_FORWARD_4:
     case DALI_FRAME_QUERY_4:
-        return settling_time_us[4];
+        return rx.settling.forward_us[3];
     case DALI_FRAME_FORWARD_5:
     case DALI_FRAME_QUERY_5:
-        return settling_time_us[5];
+        return rx.settling.forward_us[4];
     case DALI_FRAME_BACK_TO_BACK:
-        return settling_time_us[6];
+        return rx.settling.back_to_back_us;
     default:
         return 0;
     }
@@ -151,6 +236,13 @@ static bool is_valid_begin_bit_timing(const uint32_t time_difference_us)
     return true;
 }
 
+static void observe_frame(void)
+{
+    if (rx.observer) {
+        rx.observer(&rx.frame);
+    }
+}
+
 void queue_error_frame(enum dali_status code, uint8_t bit, uint32_t time_us)
 {
     if (rx.status == ERROR_IN_FRAME) {
@@ -158,19 +250,25 @@ void queue_error_frame(enum dali_status code, uint8_t bit, uint32_t time_us)
     }
     if (rx.status == IDLE) {
         rx.frame.timestamp = pdTICKS_TO_MS(xTaskGetTickCount());
+        rx.frame.time_us = board_dali_rx_get_count();
     }
     if (rx.status == LOW) {
         rx.frame.timestamp = pdTICKS_TO_MS(xTaskGetTickCount()) - (rx_timing.min_failure_condition_us / 1000);
+        rx.frame.time_us = board_dali_rx_get_count() - rx_timing.min_failure_condition_us;
     }
     rx.frame.status = code;
     rx.frame.length = 0;
     rx.frame.data = (time_us & 0xffffff) << 8 | bit;
+    observe_frame();
     xQueueSendToBack(rx.queue_handle, &rx.frame, 0);
     rx.status = ERROR_IN_FRAME;
 }
 
 static uint32_t frame_start_count(enum dali_frame_type type)
 {
+    if (rx.response_delay_us) {
+        return rx.last_full_frame_count + rx.response_delay_us;
+    }
     if (type == DALI_FRAME_BACKWARD) {
         return rx.last_full_frame_count + get_settling_time_us(type);
     } else {
@@ -178,14 +276,49 @@ static uint32_t frame_start_count(enum dali_frame_type type)
     }
 }
 
-static void schedule_settling_timeout(enum dali_frame_type type)
+// A waiting frame is started by the transmit timer at the match, without the latency
+// of the interrupt and the receiver task. The period match only finishes the inter frame idle.
+static uint32_t schedule_period_match(uint32_t match_count)
 {
-    rx.end_inter_frame_idle = frame_start_count(type);
+    taskENTER_CRITICAL();
     const uint32_t timer_now = board_dali_rx_get_count();
-    if ((rx.end_inter_frame_idle - timer_now) < 100)
-        rx.end_inter_frame_idle = timer_now + 100;
-    board_dali_rx_set_period_match(rx.end_inter_frame_idle);
+    if ((int32_t)(match_count - timer_now) < (int32_t)rx.settling.min_slack_us) {
+        match_count = timer_now + rx.settling.min_slack_us;
+    }
+    if (rx.transmission_is_waiting) {
+        dali_tx_schedule_send(match_count - timer_now);
+        rx.scheduled_start = match_count;
+        rx.start_is_scheduled = true;
+    }
+    taskEXIT_CRITICAL();
+    board_dali_rx_set_period_match(match_count);
     board_dali_rx_period_match_enable(true);
+    return match_count;
+}
+
+static void schedule_settling_timeout(enum dali_frame_type type)
+{
+    rx.end_inter_frame_idle = schedule_period_match(frame_start_count(type));
+}
+
+// the deviation includes the delay of the falling edge from the transmitter to the receiver
+static void measure_start(void)
+{
+    if (!rx.start_is_scheduled) {
+        return;
+    }
+    rx.start_is_scheduled = false;
+    const int32_t delay_us = rx.edge_count - rx.scheduled_start;
+    taskENTER_CRITICAL();
+    if (rx.start.count == 0 || delay_us < rx.start.delay_min_us) {
+        rx.start.delay_min_us = delay_us;
+    }
+    if (rx.start.count == 0 || delay_us > rx.start.delay_max_us) {
+        rx.start.delay_max_us = delay_us;
+    }
+    rx.start.count++;
+    rx.start.delay_sum_us += delay_us;
+    taskEXIT_CRITICAL();
 }
 
 static void rx_reset(void)
@@ -198,10 +331,12 @@ static void generate_timeout_frame(void)
 {
     if (rx.status == IDLE || rx.status == INTER_FRAME_IDLE) {
         rx.frame.timestamp = pdTICKS_TO_MS(xTaskGetTickCount());
+        rx.frame.time_us = board_dali_rx_get_count();
         rx.frame.status = DALI_TIMEOUT;
         rx.frame.length = 0;
         rx.frame.loopback = false;
         rx.frame.data = 0;
+        observe_frame();
         xQueueSendToBack(rx.queue_handle, &rx.frame, 0);
         rx_reset();
     }
@@ -227,9 +362,37 @@ static uint32_t get_corrected_time_difference_us(bool invert)
 {
     const uint32_t time_difference_us = rx.edge_count - rx.last_edge_count;
     if (rx.last_data_bit ^ invert) {
-        return time_difference_us + (DALI_RX_FALL_US - DALI_RX_RISE_US);
+        return time_difference_us + rx.asymmetry_us;
+    }
+    return time_difference_us - rx.asymmetry_us;
+}
+
+// the phase that ended with the current edge, without correction
+static void measure_phase(void)
+{
+    if (rx.measure == DALI_MEASURE_OFF || (rx.measure == DALI_MEASURE_LOOPBACK) != rx.frame.loopback) {
+        return;
+    }
+    const uint32_t duration_us = rx.edge_count - rx.last_edge_count;
+    int32_t error;
+    if (duration_us <= MEASURE_FULL_BIT_LIMIT_US) {
+        error = 3 * (int32_t)duration_us - MEASURE_HALF_BIT_THIRDS;
+    } else if (duration_us <= MEASURE_MAX_PHASE_US) {
+        error = 3 * (int32_t)duration_us - MEASURE_FULL_BIT_THIRDS;
+    } else {
+        return;
     }
-    return time_difference_us - (DALI_RX_FALL_US - DALI_RX_RISE_US);
+    const enum dali_phase phase = (board_dali_rx_pin() == DALI_RX_IDLE) ? DALI_PHASE_ACTIVE : DALI_PHASE_IDLE;
+    taskENTER_CRITICAL();
+    if (rx.phases.count[phase] == 0 || error < rx.phases.error_min[phase]) {
+        rx.phases.error_min[phase] = error;
+    }
+    if (rx.phases.count[phase] == 0 || error > rx.phases.error_max[phase]) {
+        rx.phases.error_max[phase] = error;
+    }
+    rx.phases.count[phase]++;
+    rx.phases.error_sum[phase] += error;
+    taskEXIT_CRITICAL();
 }
 
 static void check_start_timing(void)
@@ -281,15 +444,18 @@ static bool is_frame_received_twice(void)
     return false;
 }
 
-static void queue_frame(void)
+static struct dali_rx_frame queue_frame(void)
 {
     rx.last_full_frame_count = rx.last_edge_count;
     rx.frame.twice = is_frame_received_twice();
+    observe_frame();
     const BaseType_t result = xQueueSendToBack(rx.queue_handle, &rx.frame, 0);
     if (result == errQUEUE_FULL) {
         configASSERT(false);
     }
+    const struct dali_rx_frame frame = rx.frame;
     rx.frame = (struct dali_rx_frame){ 0 };
+    return frame;
 }
 
 static void process_pending_frame(void)
@@ -312,21 +478,111 @@ void rx_schedule_transmission(enum dali_frame_type type)
     }
     if (rx.status == INTER_FRAME_IDLE) {
         const uint32_t timer_now = board_dali_rx_get_count();
-        uint32_t scheduled_start = frame_start_count(type);
-        if (timer_now >= scheduled_start) {
+        const uint32_t scheduled_start = frame_start_count(type);
+        if ((int32_t)(scheduled_start - timer_now) <= 0) {
             dali_tx_start_send();
             return;
         }
-        if (scheduled_start < rx.end_inter_frame_idle) {
-            if ((scheduled_start - timer_now) < 100)
-                scheduled_start = timer_now + 100;
-            board_dali_rx_set_period_match(scheduled_start);
-            board_dali_rx_period_match_enable(true);
-        }
+        // the start can be later than the end of the inter frame idle, e.g. a response with a long delay
+        rx.transmission_is_waiting = true;
+        schedule_period_match(scheduled_start);
+        return;
     }
     rx.transmission_is_waiting = true;
 }
 
+void rx_arm_transmission(enum dali_frame_type type, uint32_t time_us)
+{
+    rx.armed_frame_type = type;
+    rx.trigger_state = TRIGGER_OFF;
+    // a start match closer than the slack can be missed by the timer
+    if ((int32_t)(time_us - board_dali_rx_get_count()) < (int32_t)rx.settling.min_slack_us) {
+        xTaskNotify(rx.task_handle, NOTIFY_START, eSetBits);
+        return;
+    }
+    board_dali_rx_set_start_match(time_us);
+    board_dali_rx_start_match_enable(true);
+}
+
+void rx_arm_trigger(enum dali_frame_type type, const struct dali_trigger* trigger)
+{
+    board_dali_rx_start_match_enable(false);
+    rx.transmission_frame_type = type;
+    rx.trigger = *trigger;
+    rx.trigger_state = TRIGGER_ARMED;
+}
+
+static void fire_trigger(void)
+{
+    const uint32_t start_count = rx.trigger_start_count + rx.trigger.delay_us;
+    if ((int32_t)(start_count - board_dali_rx_get_count()) < (int32_t)rx.settling.min_slack_us) {
+        rx.trigger_state = TRIGGER_OFF;
+        if (dali_tx_release()) {
+            dali_tx_start_send();
+        }
+        return;
+    }
+    rx.trigger_state = TRIGGER_FIRED;
+    board_dali_rx_set_start_match(start_count);
+    board_dali_rx_start_match_enable(true);
+}
+
+static void trigger_on_start_bit(void)
+{
+    if (rx.trigger_state != TRIGGER_ARMED && rx.trigger_state != TRIGGER_PREFIX) {
+        return;
+    }
+    rx.trigger_start_count = rx.edge_count;
+    if (rx.trigger.prefix_length) {
+        rx.trigger_state = TRIGGER_PREFIX;
+        return;
+    }
+    fire_trigger();
+}
+
+// the data bits are compared as soon as enough of them are received,
+// a frame with other data bits re-arms the trigger for the next frame
+static void trigger_on_data_bit(void)
+{
+    if (rx.trigger_state != TRIGGER_PREFIX || rx.frame.length < rx.trigger.prefix_length) {
+        return;
+    }
+    const uint32_t prefix = rx.frame.data >> (rx.frame.length - rx.trigger.prefix_length);
+    if (prefix == rx.trigger.prefix) {
+        fire_trigger();
+    } else {
+        rx.trigger_state = TRIGGER_ARMED;
+    }
+}
+
+// the armed frame is scheduled like any other frame, so
+// the settling times apply after the start time has come
+static void process_start_match(void)
+{
+    if (dali_tx_release()) {
+        rx_schedule_transmission(rx.armed_frame_type);
+    }
+}
+
+// the transmitter dropped the scheduled start, or started the frame without the timer
+void rx_clear_scheduled_start(void)
+{
+    rx.start_is_scheduled = false;
+}
+
+bool rx_is_transmission_waiting(void)
+{
+    return rx.transmission_is_waiting;
+}
+
+bool rx_cancel_transmission(void)
+{
+    const bool waiting = rx.transmission_is_waiting;
+    rx.transmission_is_waiting = false;
+    rx.start_is_scheduled = false;
+    return waiting;
+}
+
 void rx_schedule_query(void)
 {
     const uint32_t timer_now = board_dali_rx_get_count();
@@ -335,9 +591,27 @@ void rx_schedule_query(void)
     board_dali_rx_query_match_enable(true);
 }
 
+// the backward frame is sent from the receiver task, so the response
+// does not depend on the latency of the serial link or the main task.
+// While it waits for its delay the transmitter is busy, no other frame replaces it.
+static void respond_to_frame(const struct dali_rx_frame* frame)
+{
+    if (rx.responder == NULL || frame->loopback || !dali_101_tx_is_idle()) {
+        return;
+    }
+    struct dali_tx_frame reply = { .type = DALI_FRAME_BACKWARD, .length = 8 };
+    uint32_t delay_us = 0;
+    if (!rx.responder(frame, &reply, &delay_us)) {
+        return;
+    }
+    rx.response_delay_us = delay_us ? delay_us : get_settling_time_us(DALI_FRAME_BACKWARD);
+    dali_101_send(reply);
+    rx.response_delay_us = 0;
+}
+
 static void manage_tx(void)
 {
-    if (dali_101_tx_is_idle()) {
+    if (!dali_101_tx_is_sending()) {
         return;
     }
     if (dali_tx_repeat()) {
@@ -362,24 +636,36 @@ static void process_capture_notification(void)
             set_new_status(START_BIT_START);
             rx.last_data_bit = true;
             rx.frame.timestamp = pdTICKS_TO_MS(xTaskGetTickCount());
-            rx.frame.loopback = !dali_101_tx_is_idle();
+            rx.frame.time_us = rx.edge_count;
+            rx.frame.loopback = dali_101_tx_is_sending();
             board_dali_rx_query_match_enable(false);
             board_dali_rx_period_match_enable(false);
+            if (rx.frame.loopback) {
+                measure_start();
+            } else {
+                trigger_on_start_bit();
+            }
         }
         break;
     case START_BIT_START:
+        measure_phase();
         check_start_timing();
         set_new_status(START_BIT_INSIDE);
         break;
     case START_BIT_INSIDE:
+        measure_phase();
         set_new_status(check_inside_timing());
         break;
     case DATA_BIT_START:
+        measure_phase();
         check_start_timing();
         set_new_status(DATA_BIT_INSIDE);
+        trigger_on_data_bit();
         break;
     case DATA_BIT_INSIDE:
+        measure_phase();
         set_new_status(check_inside_timing());
+        trigger_on_data_bit();
         break;
     case ERROR_IN_FRAME:
         break;
@@ -398,6 +684,7 @@ static void process_capture_notification(void)
     case FAILURE:
         if (board_dali_rx_pin() == DALI_RX_IDLE) {
             rx.frame.timestamp = pdTICKS_TO_MS(xTaskGetTickCount());
+            rx.frame.time_us = rx.edge_count;
             const uint32_t time_difference_us = get_corrected_time_difference_us(false);
             queue_error_frame(DALI_SYSTEM_RECOVER, 0, time_difference_us);
             manage_tx();
@@ -416,16 +703,23 @@ static void process_match_notification(void)
     if (board_dali_rx_pin() == DALI_RX_IDLE) {
         switch (rx.status) {
         case IDLE:
+            // the bus recovered from a failure, a waiting frame starts after the settling time
+            if (rx.transmission_is_waiting) {
+                process_pending_frame();
+            }
+            return;
         case INTER_FRAME_IDLE:
             return;
         case START_BIT_START:
         case START_BIT_INSIDE:
         case DATA_BIT_START:
-        case DATA_BIT_INSIDE:
+        case DATA_BIT_INSIDE: {
             manage_tx();
-            queue_frame();
+            const struct dali_rx_frame frame = queue_frame();
             process_pending_frame();
+            respond_to_frame(&frame);
             return;
+        }
         case LOW:
         case FAILURE:
         case ERROR_IN_FRAME:
@@ -454,6 +748,14 @@ static void process_match_notification(void)
 
 static void process_priority_timeout(void)
 {
+    // the transmit timer started the waiting frame already
+    if (rx.transmission_is_waiting && dali_101_tx_is_sending()) {
+        rx.transmission_is_waiting = false;
+    }
+    // a frame that started meanwhile keeps the bus busy, the waiting frame was cancelled
+    if (rx.status != INTER_FRAME_IDLE) {
+        return;
+    }
     rx.status = IDLE;
     if (rx.transmission_is_waiting) {
         dali_tx_start_send();
@@ -461,12 +763,125 @@ static void process_priority_timeout(void)
     }
 }
 
+// the time since the last event is accounted to the state before the event
+static void account_bus_time(void)
+{
+    taskENTER_CRITICAL();
+    const uint32_t timer_now = board_dali_rx_get_count();
+    const uint32_t elapsed_us = timer_now - rx.last_account_count;
+    rx.last_account_count = timer_now;
+    switch (rx.status) {
+    case IDLE:
+    case INTER_FRAME_IDLE:
+        rx.bus_time.idle_us += elapsed_us;
+        break;
+    case LOW:
+    case FAILURE:
+        rx.bus_time.failure_us += elapsed_us;
+        break;
+    default:
+        if (rx.frame.loopback) {
+            rx.bus_time.transmit_us += elapsed_us;
+        } else {
+            rx.bus_time.foreign_us += elapsed_us;
+        }
+        break;
+    }
+    taskEXIT_CRITICAL();
+}
+
+void dali_101_get_bus_time(struct dali_bus_time* time)
+{
+    taskENTER_CRITICAL();
+    account_bus_time();
+    *time = rx.bus_time;
+    rx.bus_time = (struct dali_bus_time){ 0 };
+    taskEXIT_CRITICAL();
+}
+
+void dali_101_measure_phases(enum dali_measure source)
+{
+    taskENTER_CRITICAL();
+    rx.phases = (struct dali_phase_statistics){ 0 };
+    rx.measure = source;
+    taskEXIT_CRITICAL();
+}
+
+void dali_101_get_phase_statistics(struct dali_phase_statistics* statistics)
+{
+    taskENTER_CRITICAL();
+    *statistics = rx.phases;
+    taskEXIT_CRITICAL();
+}
+
+void dali_101_set_rx_asymmetry(int32_t asymmetry_us)
+{
+    rx.asymmetry_us = asymmetry_us;
+}
+
+int32_t dali_101_get_rx_asymmetry(void)
+{
+    return rx.asymmetry_us;
+}
+
+static bool is_valid_settling(const struct dali_settling_times* times)
+{
+    if (times->backward_us < settling_limits.min_backward_us || times->backward_us > settling_limits.max_backward_us ||
+        times->back_to_back_us < settling_limits.min_back_to_back_us ||
+        times->back_to_back_us > settling_limits.max_back_to_back_us ||
+        times->min_slack_us < settling_limits.min_slack_us || times->min_slack_us > settling_limits.max_slack_us) {
+        return false;
+    }
+    uint32_t previous_us = settling_limits.min_forward_us;
+    for (uint_fast8_t i = 0; i < DALI_PRIORITIES; i++) {
+        if (times->forward_us[i] < previous_us || times->forward_us[i] > settling_limits.max_forward_us[i]) {
+            return false;
+        }
+        previous_us = times->forward_us[i];
+    }
+    return true;
+}
+
+bool dali_101_set_settling_times(const struct dali_settling_times* times)
+{
+    if (!is_valid_settling(times)) {
+        return false;
+    }
+    taskENTER_CRITICAL();
+    rx.settling = *times;
+    taskEXIT_CRITICAL();
+    return true;
+}
+
+void dali_101_set_settling_profile(enum dali_settling_profile profile)
+{
+    dali_101_set_settling_times(&settling_profiles[profile]);
+}
+
+void dali_101_get_settling_times(struct dali_settling_times* times)
+{
+    taskENTER_CRITICAL();
+    *times = rx.settling;
+    taskEXIT_CRITICAL();
+}
+
+void dali_101_get_start_statistics(struct dali_start_statistics* statistics, bool reset)
+{
+    taskENTER_CRITICAL();
+    *statistics = rx.start;
+    if (reset) {
+        rx.start = (struct dali_start_statistics){ 0 };
+    }
+    taskEXIT_CRITICAL();
+}
+
 __attribute__((noreturn)) static void rx_task(__attribute__((unused)) void* dummy)
 {
     while (true) {
         uint32_t notifications;
         const BaseType_t result = xTaskNotifyWait(pdFALSE, ULONG_MAX, &notifications, portMAX_DELAY);
         if (result == pdPASS) {
+            account_bus_time();
             if (notifications & NOTIFY_CAPTURE) {
                 process_capture_notification();
             }
@@ -479,6 +894,9 @@ __attribute__((noreturn)) static void rx_task(__attribute__((unused)) void* dumm
             if (notifications & NOTIFY_QUERY) {
                 generate_timeout_frame();
             }
+            if (notifications & NOTIFY_START) {
+                process_start_match();
+            }
         }
     }
 }
@@ -490,6 +908,31 @@ bool dali_101_get(struct dali_rx_frame* frame, uint32_t wait_ms, bool forever)
     return (rc == pdPASS);
 }
 
+uint32_t dali_101_get_time(void)
+{
+    return board_dali_rx_get_count();
+}
+
+bool dali_101_rx_is_idle(void)
+{
+    return (rx.status == IDLE || rx.status == INTER_FRAME_IDLE);
+}
+
+void dali_101_set_observer(dali_101_observer observer)
+{
+    rx.observer = observer;
+}
+
+void dali_101_set_edge_recorder(dali_101_edge_recorder recorder)
+{
+    rx.edge_recorder = recorder;
+}
+
+void dali_101_set_responder(dali_101_responder responder)
+{
+    rx.responder = responder;
+}
+
 static void dali_rx_init(void)
 {
     static StaticTask_t task_buffer;
@@ -503,6 +946,9 @@ static void dali_rx_init(void)
     configASSERT(rx.queue_handle);
 
     board_dali_rx_timer_setup();
+    rx.last_account_count = board_dali_rx_get_count();
+    rx.asymmetry_us = DALI_RX_FALL_US - DALI_RX_RISE_US;
+    rx.settling = settling_profiles[DALI_SETTLING_MULTI_MASTER];
 
     if (board_dali_rx_pin() == DALI_RX_IDLE) {
         rx.status = IDLE;
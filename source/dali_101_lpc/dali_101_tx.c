@@ -1,7 +1,9 @@
 #include <stdbool.h>     // for true, false, bool
 #include <stdint.h>      // for uint32_t, int_fast8_t, uint8_t, uint_fast8_t
+#include "FreeRTOS.h"    // for BaseType_t
 #include "board/dali.h"  // for board_dali_tx_set, board_dali_tx_timer_next
 #include "dali_101.h"    // for dali_tx_frame, DALI_MAX_DATA_LENGTH, DALI_ER...
+#include "task.h"        // for vTaskSuspendAll, xTaskResumeAll, taskENTER...
 
 #define COUNT_ARRAY_SIZE (2U + DALI_MAX_DATA_LENGTH * 2U + 1U) // start bit, 32 data bits, 1 stop bit
 #define EXTEND_CORRUPT_PHASE 2
@@ -26,12 +28,26 @@ struct _tx {
     uint_fast8_t index_max;
     bool state_now;
     uint8_t repeat;
+    bool repeat_pending;
+    bool armed;
     bool is_query;
+    bool scheduled;
+    int32_t compensation_us[DALI_PHASES];
 } tx;
 
+struct _sequence {
+    uint32_t period_us[COUNT_ARRAY_SIZE];
+    uint_fast8_t length;
+} sequence;
+
 extern void queue_error_frame(enum dali_status code, uint8_t bit, uint32_t time_us);
 extern void rx_schedule_transmission(enum dali_frame_type type);
 extern void rx_schedule_query(void);
+extern bool rx_cancel_transmission(void);
+extern bool rx_is_transmission_waiting(void);
+extern void rx_clear_scheduled_start(void);
+extern void rx_arm_transmission(enum dali_frame_type type, uint32_t time_us);
+extern void rx_arm_trigger(enum dali_frame_type type, const struct dali_trigger* trigger);
 
 void tx_reset(void)
 {
@@ -41,6 +57,10 @@ void tx_reset(void)
     }
     tx.index_next = 0;
     tx.index_max = 0;
+    tx.repeat_pending = false;
+    tx.armed = false;
+    tx.scheduled = false;
+    rx_clear_scheduled_start();
     tx.state_now = true;
     tx.count[0] = 0;
 }
@@ -51,15 +71,12 @@ static bool add_signal_phase(uint32_t duration_us, bool change_last_phase)
         queue_error_frame(DALI_ERROR_CAN_NOT_PROCESS, 0, 0);
         return true;
     }
-    uint32_t count_now;
-    if (tx.index_max & 1) {
-        count_now = duration_us + (DALI_TX_RISE_US + DALI_TX_FALL_US);
-    } else {
-        count_now = duration_us - (DALI_TX_RISE_US + DALI_TX_FALL_US);
-    }
     if (change_last_phase) {
         tx.index_max--;
     }
+    // even phases drive the bus active, odd phases release it
+    const enum dali_phase phase = (tx.index_max & 1) ? DALI_PHASE_IDLE : DALI_PHASE_ACTIVE;
+    uint32_t count_now = duration_us + tx.compensation_us[phase];
     if (tx.index_max) {
         count_now += tx.count[tx.index_max - 1];
     }
@@ -133,8 +150,28 @@ static bool calculate_counts(const struct dali_tx_frame frame)
     return add_stop_condition();
 }
 
+static bool load_sequence(void)
+{
+    if (sequence.length == 0) {
+        queue_error_frame(DALI_ERROR_CAN_NOT_PROCESS, 0, 0);
+        return true;
+    }
+    for (uint_fast8_t i = 0; i < sequence.length; i++) {
+        if (add_signal_phase(sequence.period_us[i], false)) {
+            return true;
+        }
+    }
+    tx.index_max--;
+    return false;
+}
+
 void dali_tx_irq_callback(void)
 {
+    // the first edge of a scheduled frame, the frame is on the bus now
+    if (tx.scheduled) {
+        tx.scheduled = false;
+        tx.repeat_pending = false;
+    }
     if (tx.index_next < tx.index_max) {
         board_dali_tx_timer_next(tx.count[tx.index_next++], NOTHING);
         return;
@@ -151,17 +188,56 @@ void dali_tx_irq_callback(void)
     }
     if (!tx.repeat)
         tx.index_next = 0;
+    else
+        tx.repeat_pending = true;
 }
 
 void dali_tx_start_send(void)
 {
+    rx_clear_scheduled_start();
+    tx.repeat_pending = false;
     tx.index_next = 1;
     board_dali_tx_timer_setup(tx.count[0]);
 }
 
+// the timer drives the first edge after the delay, the receiver task
+// does not add its latency to the start of the frame
+void dali_tx_schedule_send(uint32_t delay_us)
+{
+    tx.index_next = 0;
+    tx.scheduled = true;
+    board_dali_tx_timer_setup_delayed(delay_us);
+}
+
+// must be called with interrupts disabled, or from an interrupt
+bool dali_tx_cancel_scheduled(void)
+{
+    if (!tx.scheduled) {
+        return false;
+    }
+    board_dali_tx_timer_stop();
+    tx.scheduled = false;
+    return true;
+}
+
+// a frame that waits for the bus is not on the bus yet, but it makes the transmitter busy
 bool dali_101_tx_is_idle(void)
 {
-    return (tx.index_next == 0);
+    return (tx.index_next == 0 && !tx.armed && !tx.scheduled && !rx_is_transmission_waiting());
+}
+
+// an armed frame makes the transmitter busy, but it is not on the bus yet,
+// a scheduled frame is on the bus as soon as its time has come
+bool dali_101_tx_is_sending(void)
+{
+    return (tx.index_next != 0 || tx.scheduled);
+}
+
+bool dali_tx_release(void)
+{
+    const bool armed = tx.armed;
+    tx.armed = false;
+    return armed;
 }
 
 bool dali_tx_repeat(void)
@@ -173,47 +249,114 @@ bool dali_tx_repeat(void)
     return false;
 }
 
-void dali_101_send(const struct dali_tx_frame frame)
+uint8_t dali_101_cancel_repeat(void)
 {
-    if (frame.type == DALI_FRAME_NONE) {
-        return;
+    taskENTER_CRITICAL();
+    uint8_t discarded = tx.repeat;
+    tx.repeat = 0;
+    // the last frame is complete, its repetition did not start yet
+    if (tx.repeat_pending) {
+        if (rx_cancel_transmission()) {
+            discarded++;
+        }
+        dali_tx_cancel_scheduled();
+        tx.repeat_pending = false;
+        tx.index_next = 0;
+    }
+    if (tx.armed) {
+        tx.armed = false;
+        discarded++;
     }
+    taskEXIT_CRITICAL();
+    return discarded;
+}
+
+static bool prepare(const struct dali_tx_frame frame)
+{
     tx_reset();
-    if (calculate_counts(frame)) {
-        return;
+    if (frame.sequence) {
+        if (load_sequence()) {
+            return false;
+        }
+    } else if (calculate_counts(frame)) {
+        return false;
     }
     if (frame.type == DALI_FRAME_QUERY_1 || frame.type == DALI_FRAME_QUERY_2 || frame.type == DALI_FRAME_QUERY_3 ||
         frame.type == DALI_FRAME_QUERY_4 || frame.type == DALI_FRAME_QUERY_5) {
         tx.is_query = true;
     }
     tx.repeat = frame.repeat;
-    rx_schedule_transmission(frame.type);
-    return;
+    return true;
 }
 
-void dali_101_sequence_start(void)
+void dali_101_send(const struct dali_tx_frame frame)
 {
-    tx_reset();
-    tx.repeat = 0;
+    if (frame.type == DALI_FRAME_NONE) {
+        return;
+    }
+    // the receiver task sends automatic responses, it must not
+    // preempt the main task while the counts are calculated
+    vTaskSuspendAll();
+    if (prepare(frame)) {
+        rx_schedule_transmission(frame.type);
+    }
+    xTaskResumeAll();
 }
 
-void dali_101_sequence_next(uint32_t period_us)
+void dali_101_send_at(const struct dali_tx_frame frame, uint32_t time_us)
 {
-    add_signal_phase(period_us, false);
+    if (frame.type == DALI_FRAME_NONE) {
+        return;
+    }
+    vTaskSuspendAll();
+    if (prepare(frame)) {
+        tx.armed = true;
+        rx_arm_transmission(frame.type, time_us);
+    }
+    xTaskResumeAll();
 }
 
-void dali_101_sequence_execute(void)
+void dali_101_send_triggered(const struct dali_tx_frame frame, const struct dali_trigger* trigger)
 {
-    if (tx.index_next >= tx.index_max || tx.index_max == 0) {
+    if (frame.type == DALI_FRAME_NONE) {
+        return;
+    }
+    vTaskSuspendAll();
+    if (prepare(frame)) {
+        tx.armed = true;
+        rx_arm_trigger(frame.type, trigger);
+    }
+    xTaskResumeAll();
+}
+
+void dali_101_sequence_start(void)
+{
+    sequence.length = 0;
+}
+
+void dali_101_sequence_next(uint32_t period_us)
+{
+    if (sequence.length >= COUNT_ARRAY_SIZE) {
         queue_error_frame(DALI_ERROR_CAN_NOT_PROCESS, 0, 0);
         return;
     }
-    tx.index_max--;
-    dali_tx_start_send();
+    sequence.period_us[sequence.length++] = period_us;
+}
+
+void dali_101_set_tx_compensation(enum dali_phase phase, int32_t compensation_us)
+{
+    tx.compensation_us[phase] = compensation_us;
+}
+
+int32_t dali_101_get_tx_compensation(enum dali_phase phase)
+{
+    return tx.compensation_us[phase];
 }
 
 void dali_tx_init(void)
 {
+    tx.compensation_us[DALI_PHASE_ACTIVE] = -(DALI_TX_RISE_US + DALI_TX_FALL_US);
+    tx.compensation_us[DALI_PHASE_IDLE] = DALI_TX_RISE_US + DALI_TX_FALL_US;
     board_dali_tx_set(DALI_TX_IDLE);
     tx_reset();
 }
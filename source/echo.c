@@ -0,0 +1,105 @@
+#include <stdbool.h> // for bool, false, true
+#include <stdint.h>  // for uint8_t, uint32_t, uint_fast8_t
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "dali_101_lpc/dali_101.h"
+#include "serial.h"
+#include "echo.h"
+
+// the loopback of a frame can still wait in the receive queue
+// when the next frame is sent, remember the last two frames
+#define ECHO_EXPECTED_FRAMES (2U)
+#define ECHO_REPORT_SIZE (12U)
+
+struct _expected {
+    uint32_t data;
+    uint8_t length;
+    uint_fast16_t count; // loopbacks still expected, one for each repetition
+};
+
+static struct _echo {
+    struct _expected expected[ECHO_EXPECTED_FRAMES];
+    uint32_t suppressed;
+    uint32_t mismatched;
+    uint32_t failed;
+    TickType_t period;
+    TickType_t next_report;
+    bool enabled;
+} echo = { 0 };
+
+void echo_configure(bool enable, uint32_t period_ms)
+{
+    taskENTER_CRITICAL();
+    echo.enabled = enable;
+    echo.period = pdMS_TO_TICKS(period_ms);
+    echo.next_report = xTaskGetTickCount() + echo.period;
+    echo.suppressed = 0;
+    echo.mismatched = 0;
+    echo.failed = 0;
+    taskEXIT_CRITICAL();
+}
+
+// the main task and the urgent frames of the serial task register frames
+void echo_expect(const struct dali_tx_frame* frame)
+{
+    taskENTER_CRITICAL();
+    echo.expected[1] = echo.expected[0];
+    // the loopback of a bit sequence or a corrupt frame is never suppressed
+    if (frame->sequence || frame->type == DALI_FRAME_CORRUPT) {
+        echo.expected[0] = (struct _expected){ .length = 0 };
+    } else {
+        echo.expected[0] =
+            (struct _expected){ .data = frame->data, .length = frame->length, .count = frame->repeat + 1U };
+    }
+    taskEXIT_CRITICAL();
+}
+
+static bool is_expected(const struct dali_rx_frame* frame)
+{
+    for (uint_fast8_t i = 0; i < ECHO_EXPECTED_FRAMES; i++) {
+        struct _expected* expected = &echo.expected[i];
+        if (expected->count && expected->length == frame->length && expected->data == frame->data) {
+            expected->count--;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool echo_pass(const struct dali_rx_frame* frame)
+{
+    if (!echo.enabled || !frame->loopback) {
+        return true;
+    }
+    taskENTER_CRITICAL();
+    bool pass = true;
+    if (frame->status != DALI_OK) {
+        echo.failed++;
+    } else if (is_expected(frame)) {
+        echo.suppressed++;
+        pass = false;
+    } else {
+        echo.mismatched++;
+    }
+    taskEXIT_CRITICAL();
+    return pass;
+}
+
+void echo_run(void)
+{
+    uint8_t result[ECHO_REPORT_SIZE];
+    taskENTER_CRITICAL();
+    const TickType_t now = xTaskGetTickCount();
+    if (!echo.enabled || !echo.period || (int32_t)(now - echo.next_report) < 0) {
+        taskEXIT_CRITICAL();
+        return;
+    }
+    echo.next_report = now + echo.period;
+    serial_put_uint32(&result[0], echo.suppressed);
+    serial_put_uint32(&result[4], echo.mismatched);
+    serial_put_uint32(&result[8], echo.failed);
+    taskEXIT_CRITICAL();
+    serial_print_block(SERIAL_REPORT_ECHO, result, sizeof(result));
+}
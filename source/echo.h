@@ -0,0 +1,38 @@
+#pragma once
+#include <stdbool.h>               // for bool
+#include <stdint.h>                // for uint32_t
+#include "dali_101_lpc/dali_101.h" // for dali_rx_frame, dali_tx_frame
+
+#define ECHO_DEFAULT_PERIOD_MS (1000U)
+
+/**
+ * @brief Enable or disable the suppression of loopback frames
+ *
+ * @param enable `true` - suppress loopback frames that match the transmitted frame
+ * @param period_ms period of the counter message in milliseconds, 0 - no counter message
+ */
+void echo_configure(bool enable, uint32_t period_ms);
+
+/**
+ * @brief Remember a transmitted frame whose loopback is output, one loopback is expected for each
+ * repetition. Called by the main task and for urgent frames. The engines consume the loopback of
+ * their frames, these frames are not registered.
+ *
+ * @param frame frame passed to the low level driver
+ */
+void echo_expect(const struct dali_tx_frame* frame);
+
+/**
+ * @brief Decide if a received frame is output. Must be called from the main task.
+ *
+ * @param frame received frame
+ * @return `true` - output the frame
+ * @return `false` - frame is a successful loopback and suppressed
+ */
+bool echo_pass(const struct dali_rx_frame* frame);
+
+/**
+ * @brief Output the counter message when it is due. Must be called from the main task.
+ *
+ */
+void echo_run(void);
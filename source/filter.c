@@ -0,0 +1,98 @@
+#include <stdbool.h> // for bool, false, true
+#include <stdint.h>  // for uint8_t, uint32_t, uint_fast8_t
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "dali_101_lpc/dali_101.h"
+#include "serial.h"
+#include "filter.h"
+
+#define FILTER_REPORT_SIZE (4U + 4U * FILTER_MAX_RULES)
+
+// rules are changed by the serial task inside critical sections,
+// frames are checked and counted in the main task
+static struct _filter {
+    struct filter_rule rule[FILTER_MAX_RULES];
+    uint32_t matched[FILTER_MAX_RULES];
+    uint32_t suppressed;
+    uint_fast8_t n_rules;
+    bool include_rules;
+} filter = { 0 };
+
+static enum filter_class get_class(const struct dali_rx_frame* frame)
+{
+    if (frame->status == DALI_OK) {
+        return FILTER_VALID;
+    }
+    if (frame->status == DALI_TIMEOUT) {
+        return FILTER_TIMEOUT;
+    }
+    return FILTER_ERROR;
+}
+
+bool filter_is_match(const struct filter_rule* rule, const struct dali_rx_frame* frame)
+{
+    if ((rule->source == FILTER_LOOPBACK && !frame->loopback) || (rule->source == FILTER_FOREIGN && frame->loopback)) {
+        return false;
+    }
+    if (rule->class != FILTER_ANY_STATUS && rule->class != get_class(frame)) {
+        return false;
+    }
+    if (rule->length && rule->length != frame->length) {
+        return false;
+    }
+    return ((frame->data ^ rule->value) & rule->mask) == 0;
+}
+
+void filter_clear(void)
+{
+    taskENTER_CRITICAL();
+    filter = (struct _filter){ 0 };
+    taskEXIT_CRITICAL();
+}
+
+bool filter_add(const struct filter_rule rule)
+{
+    bool result = false;
+    taskENTER_CRITICAL();
+    if (filter.n_rules < FILTER_MAX_RULES) {
+        filter.matched[filter.n_rules] = 0;
+        filter.rule[filter.n_rules++] = rule;
+        filter.include_rules |= (rule.action == FILTER_INCLUDE);
+        result = true;
+    }
+    taskEXIT_CRITICAL();
+    return result;
+}
+
+void filter_report(void)
+{
+    uint8_t result[FILTER_REPORT_SIZE];
+    taskENTER_CRITICAL();
+    const uint_fast8_t n_rules = filter.n_rules;
+    serial_put_uint32(&result[0], filter.suppressed);
+    for (uint_fast8_t i = 0; i < n_rules; i++) {
+        serial_put_uint32(&result[4U + 4U * i], filter.matched[i]);
+    }
+    taskEXIT_CRITICAL();
+    serial_print_block(SERIAL_REPORT_FILTER, result, 4U + 4U * n_rules);
+}
+
+bool filter_pass(const struct dali_rx_frame* frame)
+{
+    taskENTER_CRITICAL();
+    bool pass = !filter.include_rules;
+    for (uint_fast8_t i = 0; i < filter.n_rules; i++) {
+        if (filter_is_match(&filter.rule[i], frame)) {
+            filter.matched[i]++;
+            pass = (filter.rule[i].action == FILTER_INCLUDE);
+            break;
+        }
+    }
+    if (!pass) {
+        filter.suppressed++;
+    }
+    taskEXIT_CRITICAL();
+    return pass;
+}
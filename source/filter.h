@@ -0,0 +1,78 @@
+#pragma once
+#include <stdbool.h>               // for bool
+#include <stdint.h>                // for uint8_t, uint32_t
+#include "dali_101_lpc/dali_101.h" // for dali_rx_frame
+
+#define FILTER_MAX_RULES (4U)
+
+enum filter_action { FILTER_INCLUDE = 0, FILTER_EXCLUDE };
+
+enum filter_source {
+    FILTER_ANY_SOURCE = 0, /**< loopback and foreign frames */
+    FILTER_LOOPBACK,       /**< frames sent by the interface */
+    FILTER_FOREIGN,        /**< frames of other bus participants */
+    FILTER_SOURCES,
+};
+
+enum filter_class {
+    FILTER_ANY_STATUS = 0, /**< all frames */
+    FILTER_VALID,          /**< frames received without error */
+    FILTER_TIMEOUT,        /**< missing backward frames */
+    FILTER_ERROR,          /**< frames with any other status */
+    FILTER_CLASSES,
+};
+
+/**
+ * @brief Rule to select frames for the output
+ *
+ */
+struct filter_rule {
+    enum filter_action action; /**< include or exclude matching frames */
+    enum filter_source source; /**< match loopback or foreign frames */
+    enum filter_class class;   /**< match the status of the frame */
+    uint8_t length;            /**< number of data bits, 0 - any length */
+    uint32_t value;            /**< expected frame data */
+    uint32_t mask;             /**< bits of the frame data to compare */
+};
+
+/**
+ * @brief Delete all rules and reset the counters, all frames are output
+ *
+ */
+void filter_clear(void);
+
+/**
+ * @brief Add a rule to the end of the rule list
+ *
+ * @param rule rule to add
+ * @return `true` - rule was added
+ * @return `false` - rule list is full
+ */
+bool filter_add(struct filter_rule rule);
+
+/**
+ * @brief Report the number of suppressed frames and the matches of each rule with a block message
+ *
+ */
+void filter_report(void);
+
+/**
+ * @brief Check if a received frame matches a rule, the action of the rule is ignored
+ *
+ * @param rule rule to check
+ * @param frame received frame
+ * @return `true` - frame matches the rule
+ */
+bool filter_is_match(const struct filter_rule* rule, const struct dali_rx_frame* frame);
+
+/**
+ * @brief Decide if a received frame is output. Must be called from the main task.
+ *
+ * The first matching rule decides. Frames that match no rule are output
+ * only when there are no include rules.
+ *
+ * @param frame received frame
+ * @return `true` - output the frame
+ * @return `false` - frame is suppressed
+ */
+bool filter_pass(const struct dali_rx_frame* frame);
@@ -0,0 +1,671 @@
+#include <stdbool.h> // for bool, false, true
+#include <stdint.h>  // for uint8_t, uint16_t, uint32_t, uint_fast8_t
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "dali_101_lpc/dali_101.h"
+#include "serial.h"
+#include "gear.h"
+
+#define GEAR_MASK (0xFFU)
+#define GEAR_YES (0xFFU)
+#define GEAR_SCENES (16U)
+#define GEAR_DTR0 (0U)
+#define GEAR_DTR1 (1U)
+#define GEAR_DTR2 (2U)
+#define GEAR_DTRS (3U)
+#define GEAR_PHYSICAL_MIN_LEVEL (1U)
+#define GEAR_MAX_LEVEL (254U)
+#define GEAR_RANDOM_RESET (0xFFFFFFUL)
+#define GEAR_VERSION (0x08U)
+#define GEAR_NO_DEVICE_TYPE (0xFEU)
+#define GEAR_FADE_TIME_RATE (0x07U)
+#define GEAR_LENGTH (16U)
+#define GEAR_REPORT_SIZE (17U)
+
+// see IEC 62386-102:2014 Table 15 - Standard commands
+#define DALI_OFF (0x00U)
+#define DALI_STEP_UP (0x03U)
+#define DALI_STEP_DOWN (0x04U)
+#define DALI_RECALL_MAX_LEVEL (0x05U)
+#define DALI_RECALL_MIN_LEVEL (0x06U)
+#define DALI_STEP_DOWN_AND_OFF (0x07U)
+#define DALI_ON_AND_STEP_UP (0x08U)
+#define DALI_GO_TO_SCENE (0x10U)
+#define DALI_RESET (0x20U)
+#define DALI_STORE_ACTUAL_LEVEL_IN_DTR0 (0x21U)
+#define DALI_SET_MAX_LEVEL (0x2AU)
+#define DALI_SET_MIN_LEVEL (0x2BU)
+#define DALI_SET_SYSTEM_FAILURE_LEVEL (0x2CU)
+#define DALI_SET_POWER_ON_LEVEL (0x2DU)
+#define DALI_SET_SCENE (0x40U)
+#define DALI_REMOVE_FROM_SCENE (0x50U)
+#define DALI_ADD_TO_GROUP (0x60U)
+#define DALI_REMOVE_FROM_GROUP (0x70U)
+#define DALI_SET_SHORT_ADDRESS (0x80U)
+#define DALI_ENABLE_WRITE_MEMORY (0x81U)
+#define DALI_FIRST_CONFIGURATION (0x20U)
+#define DALI_LAST_CONFIGURATION (0x81U)
+#define DALI_QUERY_STATUS (0x90U)
+#define DALI_QUERY_CONTROL_GEAR_PRESENT (0x91U)
+#define DALI_QUERY_LAMP_POWER_ON (0x93U)
+#define DALI_QUERY_LIMIT_ERROR (0x94U)
+#define DALI_QUERY_RESET_STATE (0x95U)
+#define DALI_QUERY_MISSING_SHORT_ADDRESS (0x96U)
+#define DALI_QUERY_VERSION_NUMBER (0x97U)
+#define DALI_QUERY_CONTENT_DTR0 (0x98U)
+#define DALI_QUERY_DEVICE_TYPE (0x99U)
+#define DALI_QUERY_PHYSICAL_MINIMUM (0x9AU)
+#define DALI_QUERY_CONTENT_DTR1 (0x9CU)
+#define DALI_QUERY_CONTENT_DTR2 (0x9DU)
+#define DALI_QUERY_ACTUAL_LEVEL (0xA0U)
+#define DALI_QUERY_MAX_LEVEL (0xA1U)
+#define DALI_QUERY_MIN_LEVEL (0xA2U)
+#define DALI_QUERY_POWER_ON_LEVEL (0xA3U)
+#define DALI_QUERY_SYSTEM_FAILURE_LEVEL (0xA4U)
+#define DALI_QUERY_FADE_TIME_RATE (0xA5U)
+#define DALI_QUERY_SCENE_LEVEL (0xB0U)
+#define DALI_QUERY_GROUPS_0_7 (0xC0U)
+#define DALI_QUERY_GROUPS_8_15 (0xC1U)
+#define DALI_QUERY_RANDOM_ADDRESS_H (0xC2U)
+#define DALI_QUERY_RANDOM_ADDRESS_M (0xC3U)
+#define DALI_QUERY_RANDOM_ADDRESS_L (0xC4U)
+#define DALI_READ_MEMORY_LOCATION (0xC5U)
+
+// see IEC 62386-102:2014 Table 16 - Special commands, address byte only
+#define DALI_TERMINATE (0xA1U)
+#define DALI_DTR0 (0xA3U)
+#define DALI_INITIALISE (0xA5U)
+#define DALI_RANDOMISE (0xA7U)
+#define DALI_COMPARE (0xA9U)
+#define DALI_WITHDRAW (0xABU)
+#define DALI_SEARCHADDRH (0xB1U)
+#define DALI_SEARCHADDRM (0xB3U)
+#define DALI_SEARCHADDRL (0xB5U)
+#define DALI_PROGRAM_SHORT_ADDRESS (0xB7U)
+#define DALI_VERIFY_SHORT_ADDRESS (0xB9U)
+#define DALI_QUERY_SHORT_ADDRESS (0xBBU)
+#define DALI_DTR1 (0xC3U)
+#define DALI_DTR2 (0xC5U)
+#define DALI_WRITE_MEMORY_LOCATION (0xC7U)
+#define DALI_WRITE_MEMORY_LOCATION_NO_REPLY (0xC9U)
+#define DALI_FIRST_SPECIAL (0xA1U)
+#define DALI_LAST_SPECIAL (0xCBU)
+
+// see IEC 62386-102:2014 9.16 - Status information
+#define STATUS_LAMP_ON (1U << 2U)
+#define STATUS_LIMIT_ERROR (1U << 3U)
+#define STATUS_RESET_STATE (1U << 5U)
+#define STATUS_MISSING_SHORT_ADDRESS (1U << 6U)
+#define STATUS_POWER_CYCLE_SEEN (1U << 7U)
+
+#define FLAG_INITIALISE (1U << 0U)
+#define FLAG_WITHDRAWN (1U << 1U)
+#define FLAG_LIMIT_ERROR (1U << 2U)
+#define FLAG_POWER_CYCLE_SEEN (1U << 3U)
+#define FLAG_WRITE_ENABLED (1U << 4U)
+
+// memory bank 1 holds the lock byte and a few bytes of user data
+#define BANK_1_LAST_LOCATION (0x05U)
+#define BANK_1_LOCK_LOCATION (0x02U)
+#define BANK_1_FIRST_DATA_LOCATION (0x03U)
+#define BANK_1_DATA_SIZE (BANK_1_LAST_LOCATION - BANK_1_FIRST_DATA_LOCATION + 1U)
+#define BANK_1_UNLOCK (0x55U)
+
+// memory bank 0, the last byte of the identification number is the index of the control gear
+static const uint8_t bank_0[] = {
+    0x12,                                           // last accessible location
+    0x00,                                           // reserved
+    0x01,                                           // last accessible memory bank
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,             // GTIN
+    0x01, 0x00,                                     // firmware version
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // identification number
+};
+#define BANK_0_INDEX_LOCATION (sizeof(bank_0) - 1U)
+
+struct _gear {
+    uint32_t random_address;
+    uint16_t groups;
+    uint8_t scene[GEAR_SCENES];
+    uint8_t dtr[GEAR_DTRS];
+    uint8_t short_address;
+    uint8_t actual_level;
+    uint8_t max_level;
+    uint8_t min_level;
+    uint8_t power_on_level;
+    uint8_t system_failure_level;
+    uint8_t lock_byte;
+    uint8_t bank_1[BANK_1_DATA_SIZE];
+    uint8_t flags;
+};
+
+// the control gear live in the receiver task, which has the higher priority,
+// changes from the serial task are made inside critical sections
+static struct _emulator {
+    struct _gear gear[GEAR_MAX_DEVICES];
+    uint_fast8_t n_gear;
+    uint32_t search_address;
+    uint32_t random_state;
+} emulator = { .random_state = 0x2545F491UL };
+
+static uint32_t next_random(uint32_t seed)
+{
+    uint32_t x = emulator.random_state ^ seed;
+    x ^= x << 13U;
+    x ^= x >> 17U;
+    x ^= x << 5U;
+    emulator.random_state = x;
+    return x;
+}
+
+static void reset_gear(struct _gear* gear)
+{
+    gear->random_address = GEAR_RANDOM_RESET;
+    gear->groups = 0;
+    for (uint_fast8_t i = 0; i < GEAR_SCENES; i++) {
+        gear->scene[i] = GEAR_MASK;
+    }
+    gear->actual_level = GEAR_MAX_LEVEL;
+    gear->max_level = GEAR_MAX_LEVEL;
+    gear->min_level = GEAR_PHYSICAL_MIN_LEVEL;
+    gear->power_on_level = GEAR_MAX_LEVEL;
+    gear->system_failure_level = GEAR_MAX_LEVEL;
+    gear->flags &= ~(FLAG_LIMIT_ERROR | FLAG_POWER_CYCLE_SEEN);
+}
+
+static bool is_reset_state(const struct _gear* gear)
+{
+    for (uint_fast8_t i = 0; i < GEAR_SCENES; i++) {
+        if (gear->scene[i] != GEAR_MASK) {
+            return false;
+        }
+    }
+    return (gear->random_address == GEAR_RANDOM_RESET && gear->groups == 0 && gear->actual_level == GEAR_MAX_LEVEL &&
+            gear->max_level == GEAR_MAX_LEVEL && gear->min_level == GEAR_PHYSICAL_MIN_LEVEL &&
+            gear->power_on_level == GEAR_MAX_LEVEL && gear->system_failure_level == GEAR_MAX_LEVEL);
+}
+
+static uint8_t get_status(const struct _gear* gear)
+{
+    uint8_t status = 0;
+    if (gear->actual_level) {
+        status |= STATUS_LAMP_ON;
+    }
+    if (gear->flags & FLAG_LIMIT_ERROR) {
+        status |= STATUS_LIMIT_ERROR;
+    }
+    if (is_reset_state(gear)) {
+        status |= STATUS_RESET_STATE;
+    }
+    if (gear->short_address == GEAR_NO_ADDRESS) {
+        status |= STATUS_MISSING_SHORT_ADDRESS;
+    }
+    if (gear->flags & FLAG_POWER_CYCLE_SEEN) {
+        status |= STATUS_POWER_CYCLE_SEEN;
+    }
+    return status;
+}
+
+static void set_level(struct _gear* gear, uint8_t level)
+{
+    if (level == GEAR_MASK) {
+        return;
+    }
+    gear->flags &= ~FLAG_LIMIT_ERROR;
+    if (level && level < gear->min_level) {
+        level = gear->min_level;
+        gear->flags |= FLAG_LIMIT_ERROR;
+    }
+    if (level > gear->max_level) {
+        level = gear->max_level;
+        gear->flags |= FLAG_LIMIT_ERROR;
+    }
+    gear->actual_level = level;
+}
+
+static uint8_t limit(uint8_t value, uint8_t lower, uint8_t upper)
+{
+    if (value < lower) {
+        return lower;
+    }
+    if (value > upper) {
+        return upper;
+    }
+    return value;
+}
+
+static bool is_addressed(const struct _gear* gear, uint8_t address)
+{
+    if ((address & 0x80U) == 0) {
+        return ((address >> 1U) == gear->short_address);
+    }
+    if ((address & 0xE0U) == 0x80U) {
+        return (gear->groups & (1U << ((address >> 1U) & 0x0FU)));
+    }
+    if ((address & 0xFEU) == 0xFCU) {
+        return (gear->short_address == GEAR_NO_ADDRESS);
+    }
+    return ((address & 0xFEU) == 0xFEU);
+}
+
+static bool is_selected(const struct _gear* gear)
+{
+    return ((gear->flags & FLAG_INITIALISE) && gear->random_address == emulator.search_address);
+}
+
+static bool read_memory(const struct _gear* gear, uint8_t index, uint8_t* value)
+{
+    const uint8_t location = gear->dtr[GEAR_DTR0];
+    switch (gear->dtr[GEAR_DTR1]) {
+    case 0:
+        if (location >= sizeof(bank_0)) {
+            return false;
+        }
+        *value = (location == BANK_0_INDEX_LOCATION) ? index : bank_0[location];
+        return true;
+    case 1:
+        if (location > BANK_1_LAST_LOCATION) {
+            return false;
+        }
+        if (location >= BANK_1_FIRST_DATA_LOCATION) {
+            *value = gear->bank_1[location - BANK_1_FIRST_DATA_LOCATION];
+        } else if (location == BANK_1_LOCK_LOCATION) {
+            *value = gear->lock_byte;
+        } else {
+            *value = (location == 0) ? BANK_1_LAST_LOCATION : 0;
+        }
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool write_memory(struct _gear* gear, uint8_t data)
+{
+    const uint8_t location = gear->dtr[GEAR_DTR0];
+    if (!(gear->flags & FLAG_WRITE_ENABLED) || gear->dtr[GEAR_DTR1] != 1) {
+        return false;
+    }
+    if (location == BANK_1_LOCK_LOCATION) {
+        gear->lock_byte = data;
+    } else if (location >= BANK_1_FIRST_DATA_LOCATION && location <= BANK_1_LAST_LOCATION &&
+               gear->lock_byte == BANK_1_UNLOCK) {
+        gear->bank_1[location - BANK_1_FIRST_DATA_LOCATION] = data;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static void increment_dtr0(struct _gear* gear)
+{
+    if (gear->dtr[GEAR_DTR0] < 0xFFU) {
+        gear->dtr[GEAR_DTR0]++;
+    }
+}
+
+static void set_short_address(struct _gear* gear, uint8_t data)
+{
+    if (data == GEAR_MASK) {
+        gear->short_address = GEAR_NO_ADDRESS;
+    } else if ((data & 0x81U) == 0x01U) {
+        gear->short_address = data >> 1U;
+    }
+}
+
+static void execute_configuration(struct _gear* gear, uint8_t opcode)
+{
+    if (opcode >= DALI_SET_SCENE && opcode < (DALI_SET_SCENE + GEAR_SCENES)) {
+        gear->scene[opcode - DALI_SET_SCENE] = gear->dtr[GEAR_DTR0];
+        return;
+    }
+    if (opcode >= DALI_REMOVE_FROM_SCENE && opcode < (DALI_REMOVE_FROM_SCENE + GEAR_SCENES)) {
+        gear->scene[opcode - DALI_REMOVE_FROM_SCENE] = GEAR_MASK;
+        return;
+    }
+    if (opcode >= DALI_ADD_TO_GROUP && opcode < (DALI_ADD_TO_GROUP + 16U)) {
+        gear->groups |= (1U << (opcode - DALI_ADD_TO_GROUP));
+        return;
+    }
+    if (opcode >= DALI_REMOVE_FROM_GROUP && opcode < (DALI_REMOVE_FROM_GROUP + 16U)) {
+        gear->groups &= ~(1U << (opcode - DALI_REMOVE_FROM_GROUP));
+        return;
+    }
+    switch (opcode) {
+    case DALI_RESET:
+        reset_gear(gear);
+        break;
+    case DALI_STORE_ACTUAL_LEVEL_IN_DTR0:
+        gear->dtr[GEAR_DTR0] = gear->actual_level;
+        break;
+    case DALI_SET_MAX_LEVEL:
+        gear->max_level = limit(gear->dtr[GEAR_DTR0], gear->min_level, GEAR_MAX_LEVEL);
+        if (gear->actual_level > gear->max_level) {
+            gear->actual_level = gear->max_level;
+        }
+        break;
+    case DALI_SET_MIN_LEVEL:
+        gear->min_level = limit(gear->dtr[GEAR_DTR0], GEAR_PHYSICAL_MIN_LEVEL, gear->max_level);
+        if (gear->actual_level && gear->actual_level < gear->min_level) {
+            gear->actual_level = gear->min_level;
+        }
+        break;
+    case DALI_SET_SYSTEM_FAILURE_LEVEL:
+        gear->system_failure_level = gear->dtr[GEAR_DTR0];
+        break;
+    case DALI_SET_POWER_ON_LEVEL:
+        gear->power_on_level = gear->dtr[GEAR_DTR0];
+        break;
+    case DALI_SET_SHORT_ADDRESS:
+        set_short_address(gear, gear->dtr[GEAR_DTR0]);
+        break;
+    case DALI_ENABLE_WRITE_MEMORY:
+        gear->flags |= FLAG_WRITE_ENABLED;
+        break;
+    }
+}
+
+static bool execute_query(struct _gear* gear, uint8_t index, uint8_t opcode, uint8_t* answer)
+{
+    if (opcode >= DALI_QUERY_SCENE_LEVEL && opcode < (DALI_QUERY_SCENE_LEVEL + GEAR_SCENES)) {
+        *answer = gear->scene[opcode - DALI_QUERY_SCENE_LEVEL];
+        return true;
+    }
+    switch (opcode) {
+    case DALI_QUERY_STATUS:
+        *answer = get_status(gear);
+        return true;
+    case DALI_QUERY_CONTROL_GEAR_PRESENT:
+        *answer = GEAR_YES;
+        return true;
+    case DALI_QUERY_LAMP_POWER_ON:
+        *answer = GEAR_YES;
+        return (gear->actual_level != 0);
+    case DALI_QUERY_LIMIT_ERROR:
+        *answer = GEAR_YES;
+        return (gear->flags & FLAG_LIMIT_ERROR);
+    case DALI_QUERY_RESET_STATE:
+        *answer = GEAR_YES;
+        return is_reset_state(gear);
+    case DALI_QUERY_MISSING_SHORT_ADDRESS:
+        *answer = GEAR_YES;
+        return (gear->short_address == GEAR_NO_ADDRESS);
+    case DALI_QUERY_VERSION_NUMBER:
+        *answer = GEAR_VERSION;
+        return true;
+    case DALI_QUERY_CONTENT_DTR0:
+        *answer = gear->dtr[GEAR_DTR0];
+        return true;
+    case DALI_QUERY_CONTENT_DTR1:
+        *answer = gear->dtr[GEAR_DTR1];
+        return true;
+    case DALI_QUERY_CONTENT_DTR2:
+        *answer = gear->dtr[GEAR_DTR2];
+        return true;
+    case DALI_QUERY_DEVICE_TYPE:
+        *answer = GEAR_NO_DEVICE_TYPE;
+        return true;
+    case DALI_QUERY_PHYSICAL_MINIMUM:
+        *answer = GEAR_PHYSICAL_MIN_LEVEL;
+        return true;
+    case DALI_QUERY_ACTUAL_LEVEL:
+        *answer = gear->actual_level;
+        return true;
+    case DALI_QUERY_MAX_LEVEL:
+        *answer = gear->max_level;
+        return true;
+    case DALI_QUERY_MIN_LEVEL:
+        *answer = gear->min_level;
+        return true;
+    case DALI_QUERY_POWER_ON_LEVEL:
+        *answer = gear->power_on_level;
+        return true;
+    case DALI_QUERY_SYSTEM_FAILURE_LEVEL:
+        *answer = gear->system_failure_level;
+        return true;
+    case DALI_QUERY_FADE_TIME_RATE:
+        *answer = GEAR_FADE_TIME_RATE;
+        return true;
+    case DALI_QUERY_GROUPS_0_7:
+        *answer = gear->groups;
+        return true;
+    case DALI_QUERY_GROUPS_8_15:
+        *answer = gear->groups >> 8U;
+        return true;
+    case DALI_QUERY_RANDOM_ADDRESS_H:
+    case DALI_QUERY_RANDOM_ADDRESS_M:
+    case DALI_QUERY_RANDOM_ADDRESS_L:
+        *answer = gear->random_address >> (8U * (DALI_QUERY_RANDOM_ADDRESS_L - opcode));
+        return true;
+    case DALI_READ_MEMORY_LOCATION:
+        if (read_memory(gear, index, answer)) {
+            increment_dtr0(gear);
+            return true;
+        }
+        return false;
+    default:
+        return false;
+    }
+}
+
+static bool execute_command(struct _gear* gear, uint8_t index, uint8_t opcode, bool twice, uint8_t* answer)
+{
+    if (opcode != DALI_ENABLE_WRITE_MEMORY && opcode < DALI_QUERY_STATUS) {
+        gear->flags &= ~FLAG_WRITE_ENABLED;
+    }
+    if (opcode >= DALI_FIRST_CONFIGURATION && opcode <= DALI_LAST_CONFIGURATION) {
+        // configuration commands are accepted when received twice
+        if (twice) {
+            execute_configuration(gear, opcode);
+        }
+        return false;
+    }
+    if (opcode >= DALI_QUERY_STATUS) {
+        return execute_query(gear, index, opcode, answer);
+    }
+    if (opcode >= DALI_GO_TO_SCENE && opcode < (DALI_GO_TO_SCENE + GEAR_SCENES)) {
+        set_level(gear, gear->scene[opcode - DALI_GO_TO_SCENE]);
+        return false;
+    }
+    switch (opcode) {
+    case DALI_OFF:
+        set_level(gear, 0);
+        break;
+    case DALI_STEP_UP:
+        if (gear->actual_level && gear->actual_level < gear->max_level) {
+            gear->actual_level++;
+        }
+        break;
+    case DALI_STEP_DOWN:
+        if (gear->actual_level > gear->min_level) {
+            gear->actual_level--;
+        }
+        break;
+    case DALI_RECALL_MAX_LEVEL:
+        set_level(gear, gear->max_level);
+        break;
+    case DALI_RECALL_MIN_LEVEL:
+        set_level(gear, gear->min_level);
+        break;
+    case DALI_STEP_DOWN_AND_OFF:
+        if (gear->actual_level <= gear->min_level) {
+            gear->actual_level = 0;
+        } else {
+            gear->actual_level--;
+        }
+        break;
+    case DALI_ON_AND_STEP_UP:
+        if (gear->actual_level == 0) {
+            gear->actual_level = gear->min_level;
+        } else if (gear->actual_level < gear->max_level) {
+            gear->actual_level++;
+        }
+        break;
+    }
+    return false;
+}
+
+static bool execute_special(struct _gear* gear, uint8_t address, uint8_t data, bool twice, uint8_t* answer)
+{
+    switch (address) {
+    case DALI_TERMINATE:
+        gear->flags &= ~(FLAG_INITIALISE | FLAG_WITHDRAWN);
+        return false;
+    case DALI_DTR0:
+        gear->dtr[GEAR_DTR0] = data;
+        return false;
+    case DALI_DTR1:
+        gear->dtr[GEAR_DTR1] = data;
+        return false;
+    case DALI_DTR2:
+        gear->dtr[GEAR_DTR2] = data;
+        return false;
+    case DALI_INITIALISE:
+        if (twice && (data == 0x00U || (data == 0xFFU && gear->short_address == GEAR_NO_ADDRESS) ||
+                      ((data & 0x81U) == 0x01U && (data >> 1U) == gear->short_address))) {
+            gear->flags |= FLAG_INITIALISE;
+            gear->flags &= ~FLAG_WITHDRAWN;
+        }
+        return false;
+    case DALI_RANDOMISE:
+        if (twice && (gear->flags & FLAG_INITIALISE)) {
+            gear->random_address = next_random(gear->random_address) & GEAR_RANDOM_RESET;
+        }
+        return false;
+    case DALI_COMPARE:
+        *answer = GEAR_YES;
+        return ((gear->flags & FLAG_INITIALISE) && !(gear->flags & FLAG_WITHDRAWN) &&
+                gear->random_address <= emulator.search_address);
+    case DALI_WITHDRAW:
+        if (is_selected(gear)) {
+            gear->flags |= FLAG_WITHDRAWN;
+        }
+        return false;
+    case DALI_PROGRAM_SHORT_ADDRESS:
+        if (is_selected(gear)) {
+            set_short_address(gear, data);
+        }
+        return false;
+    case DALI_VERIFY_SHORT_ADDRESS:
+        *answer = GEAR_YES;
+        return ((gear->flags & FLAG_INITIALISE) && (data >> 1U) == gear->short_address);
+    case DALI_QUERY_SHORT_ADDRESS:
+        *answer = (gear->short_address == GEAR_NO_ADDRESS) ? GEAR_MASK : ((gear->short_address << 1U) | 1U);
+        return is_selected(gear);
+    case DALI_WRITE_MEMORY_LOCATION:
+    case DALI_WRITE_MEMORY_LOCATION_NO_REPLY:
+        if (!write_memory(gear, data)) {
+            return false;
+        }
+        increment_dtr0(gear);
+        *answer = data;
+        return (address == DALI_WRITE_MEMORY_LOCATION);
+    default:
+        return false;
+    }
+}
+
+static void set_search_address(uint8_t address, uint8_t data)
+{
+    const uint_fast8_t shift = 8U * ((DALI_SEARCHADDRL - address) / 2U);
+    emulator.search_address = (emulator.search_address & ~(0xFFUL << shift)) | ((uint32_t)data << shift);
+}
+
+static bool gear_receive(uint8_t index, uint8_t address, uint8_t data, bool twice, uint8_t* answer)
+{
+    struct _gear* gear = &emulator.gear[index];
+    if (address >= DALI_FIRST_SPECIAL && address <= DALI_LAST_SPECIAL) {
+        return (address & 0x01U) ? execute_special(gear, address, data, twice, answer) : false;
+    }
+    if (!is_addressed(gear, address)) {
+        return false;
+    }
+    if (address & 0x01U) {
+        return execute_command(gear, index, data, twice, answer);
+    }
+    set_level(gear, data);
+    gear->flags &= ~FLAG_WRITE_ENABLED;
+    return false;
+}
+
+void gear_clear(void)
+{
+    taskENTER_CRITICAL();
+    emulator.n_gear = 0;
+    taskEXIT_CRITICAL();
+}
+
+bool gear_add(uint8_t short_address)
+{
+    if (short_address > 63U && short_address != GEAR_NO_ADDRESS) {
+        return false;
+    }
+    bool result = false;
+    taskENTER_CRITICAL();
+    if (emulator.n_gear < GEAR_MAX_DEVICES) {
+        struct _gear* gear = &emulator.gear[emulator.n_gear++];
+        *gear = (struct _gear){ .short_address = short_address, .lock_byte = 0xFFU };
+        reset_gear(gear);
+        gear->actual_level = gear->power_on_level;
+        gear->flags = FLAG_POWER_CYCLE_SEEN;
+        result = true;
+    }
+    taskEXIT_CRITICAL();
+    return result;
+}
+
+bool gear_report(uint8_t index)
+{
+    if (index >= emulator.n_gear) {
+        return false;
+    }
+    taskENTER_CRITICAL();
+    const struct _gear gear = emulator.gear[index];
+    taskEXIT_CRITICAL();
+    uint8_t result[GEAR_REPORT_SIZE] = { index,
+                                         gear.short_address,
+                                         get_status(&gear),
+                                         gear.actual_level,
+                                         gear.max_level,
+                                         gear.min_level,
+                                         gear.power_on_level,
+                                         gear.system_failure_level,
+                                         gear.groups >> 8U,
+                                         gear.groups,
+                                         gear.random_address >> 16U,
+                                         gear.random_address >> 8U,
+                                         gear.random_address,
+                                         gear.dtr[GEAR_DTR0],
+                                         gear.dtr[GEAR_DTR1],
+                                         gear.dtr[GEAR_DTR2],
+                                         gear.flags };
+    serial_print_block(SERIAL_REPORT_GEAR_STATE, result, sizeof(result));
+    return true;
+}
+
+bool gear_respond(const struct dali_rx_frame* frame, struct dali_tx_frame* reply,
+                  __attribute__((unused)) uint32_t* delay_us)
+{
+    if (frame->length != GEAR_LENGTH) {
+        return false;
+    }
+    const uint8_t address = frame->data >> 8U;
+    const uint8_t data = frame->data;
+    if (address == DALI_SEARCHADDRH || address == DALI_SEARCHADDRM || address == DALI_SEARCHADDRL) {
+        set_search_address(address, data);
+        return false;
+    }
+    uint_fast8_t n_answers = 0;
+    for (uint_fast8_t i = 0; i < emulator.n_gear; i++) {
+        uint8_t answer;
+        if (gear_receive(i, address, data, frame->twice, &answer)) {
+            if (n_answers && answer != reply->data) {
+                reply->type = DALI_FRAME_CORRUPT;
+            }
+            reply->data = answer;
+            n_answers++;
+        }
+    }
+    return (n_answers > 0);
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <stdbool.h>               // for bool
+#include <stdint.h>                // for uint8_t, uint32_t
+#include "dali_101_lpc/dali_101.h" // for dali_rx_frame, dali_tx_frame
+
+#define GEAR_MAX_DEVICES (4U)
+#define GEAR_NO_ADDRESS (0xFFU)
+
+/**
+ * @brief Remove all virtual control gear
+ *
+ */
+void gear_clear(void);
+
+/**
+ * @brief Add a virtual control gear in power up state
+ *
+ * @param short_address short address (0..63), or GEAR_NO_ADDRESS
+ * @return `true` - control gear was added
+ * @return `false` - bad address, or no more control gear available
+ */
+bool gear_add(uint8_t short_address);
+
+/**
+ * @brief Report the state of a virtual control gear with a block message
+ *
+ * @param index index of the control gear
+ * @return `true` - state was reported
+ * @return `false` - no control gear with this index
+ */
+bool gear_report(uint8_t index);
+
+/**
+ * @brief Apply a received frame to all virtual control gear and collect the answer
+ *
+ * Called from the receiver task, see `dali_101_responder`. Different answers of
+ * several control gear collide, the reply is a corrupt backward frame then.
+ */
+bool gear_respond(const struct dali_rx_frame* frame, struct dali_tx_frame* reply, uint32_t* delay_us);
@@ -0,0 +1,149 @@
+#include <stdbool.h> // for bool, false, true
+#include <stddef.h>  // for NULL
+#include <stdint.h>  // for uint8_t, uint32_t, uint_fast8_t
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "dali_101_lpc/dali_101.h"
+#include "bus.h"
+#include "serial.h"
+#include "macro.h"
+
+enum macro_status {
+    MACRO_OK = 0,
+    MACRO_BUS_ERROR,
+    MACRO_UNEXPECTED_REPLY,
+    MACRO_EMPTY,
+};
+
+// compact storage, a full step definition does not fit into the little RAM we have,
+// a step takes 12 bytes
+struct _step {
+    uint32_t data;
+    uint8_t type;
+    uint8_t length;
+    uint8_t repeat;
+    uint8_t parameter_shift;
+    uint8_t expected_value;
+    uint8_t expected_mask;
+    bool check_reply;
+};
+
+static struct _macro {
+    struct _step step[MACRO_MAX_STEPS];
+    uint8_t n_steps;
+} macros[MACRO_MAX_MACROS];
+
+static bool is_query(enum dali_frame_type type)
+{
+    return (type >= DALI_FRAME_QUERY_1 && type <= DALI_FRAME_QUERY_5);
+}
+
+bool macro_clear(uint8_t id)
+{
+    if (id >= MACRO_MAX_MACROS) {
+        return false;
+    }
+    macros[id].n_steps = 0;
+    return true;
+}
+
+bool macro_append(uint8_t id, const struct macro_step step)
+{
+    if (id >= MACRO_MAX_MACROS || macros[id].n_steps >= MACRO_MAX_STEPS) {
+        return false;
+    }
+    if (step.parameter_shift != MACRO_NO_PARAMETER && step.parameter_shift >= step.frame.length) {
+        return false;
+    }
+    struct _macro* macro = &macros[id];
+    macro->step[macro->n_steps++] = (struct _step){ .data = step.frame.data,
+                                                   .type = step.frame.type,
+                                                   .length = step.frame.length,
+                                                   .repeat = step.frame.repeat,
+                                                   .parameter_shift = step.parameter_shift,
+                                                   .check_reply = step.check_reply,
+                                                   .expected_value = step.expected_value,
+                                                   .expected_mask = step.expected_mask };
+    return true;
+}
+
+// bits of the parameter that fit into the frame above the shift
+static uint32_t parameter_mask(const struct _step* step)
+{
+    const uint_fast8_t width = step->length - step->parameter_shift;
+    return (width >= 32U) ? UINT32_MAX : ((1UL << width) - 1U);
+}
+
+bool macro_parameter_fits(uint8_t id, uint32_t parameter)
+{
+    if (id >= MACRO_MAX_MACROS) {
+        return false;
+    }
+    bool fits = true;
+    taskENTER_CRITICAL();
+    for (uint_fast8_t i = 0; i < macros[id].n_steps; i++) {
+        const struct _step* step = &macros[id].step[i];
+        if (step->parameter_shift != MACRO_NO_PARAMETER && (parameter & ~parameter_mask(step))) {
+            fits = false;
+        }
+    }
+    taskEXIT_CRITICAL();
+    return fits;
+}
+
+static void report_reply(uint8_t id, uint8_t index, const struct dali_rx_frame* reply)
+{
+    uint8_t result[7] = { id, index, (reply->status > DALI_OK) ? reply->status : reply->length };
+    serial_put_uint32(&result[3], reply->data);
+    serial_print_block(SERIAL_REPORT_MACRO_REPLY, result, sizeof(result));
+}
+
+static bool is_expected_reply(const struct _step* step, const struct dali_rx_frame* reply)
+{
+    if (!step->check_reply) {
+        return true;
+    }
+    if (reply->status != DALI_OK || reply->length != 8) {
+        return false;
+    }
+    return ((reply->data ^ step->expected_value) & step->expected_mask) == 0;
+}
+
+static enum macro_status execute_step(uint8_t id, uint8_t index, uint32_t parameter)
+{
+    taskENTER_CRITICAL();
+    const struct _step step = macros[id].step[index];
+    taskEXIT_CRITICAL();
+    struct dali_tx_frame frame = { .type = step.type, .length = step.length, .repeat = step.repeat, .data = step.data };
+    if (step.parameter_shift != MACRO_NO_PARAMETER) {
+        // the steps can change after the check of the parameter, never touch bits outside the frame
+        frame.data |= ((parameter & parameter_mask(&step)) << step.parameter_shift);
+    }
+    if (!is_query(frame.type)) {
+        return bus_send(frame, NULL) ? MACRO_OK : MACRO_BUS_ERROR;
+    }
+    struct dali_rx_frame reply;
+    if (!bus_query(frame, &reply)) {
+        return MACRO_BUS_ERROR;
+    }
+    report_reply(id, index, &reply);
+    return is_expected_reply(&step, &reply) ? MACRO_OK : MACRO_UNEXPECTED_REPLY;
+}
+
+void macro_execute(const struct macro_request* request)
+{
+    enum macro_status status = MACRO_EMPTY;
+    uint_fast8_t index = 0;
+    if (request->id < MACRO_MAX_MACROS) {
+        const uint_fast8_t n_steps = macros[request->id].n_steps;
+        status = (n_steps > 0) ? MACRO_OK : MACRO_EMPTY;
+        while (status == MACRO_OK && index < n_steps) {
+            status = execute_step(request->id, index, request->parameter);
+            index++;
+        }
+    }
+    const uint8_t result[] = { request->id, index, status };
+    serial_print_block(SERIAL_REPORT_MACRO_DONE, result, sizeof(result));
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <stdbool.h>               // for bool
+#include <stdint.h>                // for uint8_t, uint32_t
+#include "dali_101_lpc/dali_101.h" // for dali_tx_frame
+
+#define MACRO_MAX_MACROS (4U)
+#define MACRO_MAX_STEPS (4U)
+#define MACRO_NO_PARAMETER (0xFFU)
+
+/**
+ * @brief Single step of a macro
+ *
+ */
+struct macro_step {
+    struct dali_tx_frame frame; /**< frame to send */
+    uint8_t parameter_shift;    /**< parameter is shifted and or-ed into the data, MACRO_NO_PARAMETER if unused */
+    bool check_reply;           /**< stop execution on an unexpected reply */
+    uint8_t expected_value;     /**< expected backframe value */
+    uint8_t expected_mask;      /**< bits of the backframe to compare */
+};
+
+/**
+ * @brief Parameters for a macro execution
+ *
+ */
+struct macro_request {
+    uint8_t id;         /**< macro to execute */
+    uint32_t parameter; /**< value to substitute into the data */
+};
+
+/**
+ * @brief Delete all steps of a macro
+ *
+ * @param id macro id
+ * @return `true` - macro was cleared
+ * @return `false` - bad macro id
+ */
+bool macro_clear(uint8_t id);
+
+/**
+ * @brief Add a step to the end of a macro
+ *
+ * @param id macro id
+ * @param step step to add
+ * @return `true` - step was added
+ * @return `false` - bad macro id, or macro is full
+ */
+bool macro_append(uint8_t id, struct macro_step step);
+
+/**
+ * @brief Check that the parameter fits into the frames of all steps that use it
+ *
+ * @param id macro id
+ * @param parameter value to substitute into the data
+ * @return `true` - parameter fits
+ * @return `false` - bad macro id, or the parameter has bits beyond the length of a frame
+ */
+bool macro_parameter_fits(uint8_t id, uint32_t parameter);
+
+/**
+ * @brief Execute a macro. Must be called from the main task.
+ *
+ * @param request macro execution parameters
+ */
+void macro_execute(const struct macro_request* request);
@@ -13,26 +13,138 @@
 #include "FreeRTOS.h"               // for configMINIMAL_STACK_SIZE, StaticT...
 #include "board/board.h"            // for board_init
 #include "board/led.h"              // for board_flash, LED_DALI
+#include "bus.h"                    // for bus_transmit, bus_transmit_at, bus...
+#include "cache.h"                  // for cache_query, cache_invalidate
+#include "calibrate.h"              // for calibrate_rx, calibrate_run
+#include "capture.h"                // for capture_check, capture_record, capt...
+#include "commission.h"             // for commission_execute
+#include "condition.h"              // for condition_execute
 #include "dali_101_lpc/dali_101.h"  // for dali_101_get, dali_101_init, dali...
+#include "echo.h"                   // for echo_expect, echo_pass, echo_run
+#include "filter.h"                 // for filter_pass
+#include "gear.h"                   // for gear_respond
+#include "macro.h"                  // for macro_execute
+#include "memory_bank.h"            // for memory_bank_execute
+#include "meter.h"                  // for meter_run
 #include "portmacro.h"              // for StackType_t
+#include "responder.h"              // for responder_match
+#include "scan.h"                   // for scan_execute
+#include "schedule.h"               // for schedule_run
 #include "serial.h"                 // for serial_get, serial_init, serial_p...
+#include "settings.h"               // for settings_load, settings_save
 #include "task.h"                   // for vTaskStartScheduler, xTaskCreateS...
+#include "traffic.h"                // for traffic_init, traffic_observe
 
-#define MAIN_TASK_STACKSIZE (2U * configMINIMAL_STACK_SIZE)
+// the engines block in the main task and output their results from deep inside,
+// see statistic `Zs` for the free stack
+#define MAIN_TASK_STACKSIZE (3U * configMINIMAL_STACK_SIZE)
 #define MAIN_PRIORITY (tskIDLE_PRIORITY + 1)
 
+static void output_frame(const struct dali_rx_frame* frame)
+{
+    capture_check(frame);
+    if (echo_pass(frame) && filter_pass(frame)) {
+        serial_print_frame(*frame);
+    }
+}
+
+static void query_cached(const struct cache_request* request)
+{
+    struct dali_rx_frame loopback;
+    struct dali_rx_frame reply;
+    // the loopback is output, sent or from the cache
+    echo_expect(&request->frame);
+    const bool replied = cache_query(request, &loopback, &reply);
+    output_frame(&loopback);
+    if (replied) {
+        output_frame(&reply);
+    }
+}
+
+// forward frames can change the state of the control gear, cached replies get stale
+static bool may_change_gear(const struct serial_request* request)
+{
+    switch (request->job) {
+    case SERIAL_JOB_FRAME:
+        return request->frame.type >= DALI_FRAME_FORWARD_1 && request->frame.type <= DALI_FRAME_FORWARD_5;
+    case SERIAL_JOB_SCAN:
+    case SERIAL_JOB_CACHED_QUERY:
+    case SERIAL_JOB_CALIBRATE:
+    case SERIAL_JOB_SAVE_SETTINGS:
+        return false;
+    default:
+        return true;
+    }
+}
+
+static void process_request(const struct serial_request* request)
+{
+    if (may_change_gear(request)) {
+        cache_invalidate();
+    }
+    switch (request->job) {
+    case SERIAL_JOB_FRAME:
+        echo_expect(&request->frame);
+        bus_transmit(request->frame);
+        break;
+    case SERIAL_JOB_CACHED_QUERY:
+        query_cached(&request->cached_query);
+        break;
+    case SERIAL_JOB_TIMED_FRAME:
+        echo_expect(&request->timed_frame.frame);
+        bus_transmit_at(request->timed_frame.frame, request->timed_frame.time_us);
+        break;
+    case SERIAL_JOB_TRIGGERED_FRAME:
+        echo_expect(&request->triggered_frame.frame);
+        bus_transmit_triggered(request->triggered_frame.frame, &request->triggered_frame.trigger);
+        break;
+    case SERIAL_JOB_CALIBRATE:
+        calibrate_rx(&request->calibrate);
+        break;
+    case SERIAL_JOB_SAVE_SETTINGS:
+        settings_save();
+        break;
+    case SERIAL_JOB_SCAN:
+        scan_execute(&request->scan);
+        break;
+    case SERIAL_JOB_COMMISSION:
+        commission_execute(&request->commission);
+        break;
+    case SERIAL_JOB_MEMORY_BANK:
+        memory_bank_execute(&request->memory_bank);
+        break;
+    case SERIAL_JOB_MACRO:
+        macro_execute(&request->macro);
+        break;
+    case SERIAL_JOB_CONDITION:
+        condition_execute(&request->condition);
+        break;
+    }
+}
+
+// entries of the responder table take precedence over the virtual control gear
+static bool respond(const struct dali_rx_frame* frame, struct dali_tx_frame* reply, uint32_t* delay_us)
+{
+    return responder_match(frame, reply, delay_us) || gear_respond(frame, reply, delay_us);
+}
+
 __attribute__((noreturn)) static void main_task(__attribute__((unused)) void* dummy)
 {
     struct dali_rx_frame rx_frame;
-    struct dali_tx_frame tx_frame;
+    struct serial_request request;
     while (true) {
         if (dali_101_get(&rx_frame, 0, false)) {
             board_flash(LED_DALI);
-            serial_print_frame(rx_frame);
+            output_frame(&rx_frame);
         }
-        if (dali_101_tx_is_idle()) {
-            if (serial_get(&tx_frame, 0)) {
-                dali_101_send(tx_frame);
+        echo_run();
+        meter_run();
+        capture_run();
+        calibrate_run();
+        if (dali_101_tx_is_idle() && !serial_urgent_is_pending() && !schedule_run()) {
+            if (serial_get(&request, 0)) {
+                process_request(&request);
+                serial_done(&request);
             }
         }
     }
@@ -42,6 +154,11 @@ __attribute__((noreturn)) int main(void)
 {
     board_init();
     dali_101_init();
+    settings_load();
+    dali_101_set_responder(respond);
+    traffic_init();
+    dali_101_set_observer(traffic_observe);
+    dali_101_set_edge_recorder(capture_record);
     serial_init();
     serial_print_head();
 
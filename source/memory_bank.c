@@ -0,0 +1,111 @@
+#include <stdbool.h> // for bool, false, true
+#include <stddef.h>  // for NULL
+#include <stdint.h>  // for uint8_t, uint16_t, uint_fast8_t
+
+#include "dali_101_lpc/dali_101.h"
+#include "bus.h"
+#include "serial.h"
+#include "memory_bank.h"
+
+// see IEC 62386-102:2014 Table 15 - Standard commands, Table 16 - Special commands
+#define DALI_ENABLE_WRITE_MEMORY (0x81U)
+#define DALI_READ_MEMORY_LOCATION (0xC5U)
+#define DALI_DTR0 (0xA300U)
+#define DALI_DTR1 (0xC300U)
+#define DALI_WRITE_MEMORY_LOCATION_NO_REPLY (0xC900U)
+
+#define MEMORY_BANK_IDX_STATUS (3U)
+#define MEMORY_BANK_IDX_COUNT (4U)
+#define MEMORY_BANK_IDX_DATA (5U)
+
+enum memory_bank_status {
+    MEMORY_BANK_OK = 0,
+    MEMORY_BANK_BUS_ERROR,
+    MEMORY_BANK_NO_ANSWER,
+    MEMORY_BANK_VERIFY_FAILED,
+};
+
+static uint8_t result[MEMORY_BANK_IDX_DATA + MEMORY_BANK_MAX_READ];
+
+static uint16_t addressed_command(uint8_t address, uint8_t opcode)
+{
+    return ((((uint16_t)address << 1U) | 1U) << 8U) | opcode;
+}
+
+static bool send_command(const struct memory_bank_request* request, uint16_t data, bool twice)
+{
+    const struct dali_tx_frame frame = { .type = request->forward_type, .length = 16, .data = data, .repeat = twice };
+    return bus_send(frame, NULL);
+}
+
+static bool select_location(const struct memory_bank_request* request)
+{
+    return send_command(request, DALI_DTR1 | request->bank, false) &&
+           send_command(request, DALI_DTR0 | request->location, false);
+}
+
+// reads with auto increment of DTR0, returns the number of bytes read
+static uint_fast8_t read_locations(const struct memory_bank_request* request, enum memory_bank_status* status)
+{
+    const struct dali_tx_frame frame = { .type = request->query_type,
+                                         .length = 16,
+                                         .data = addressed_command(request->address, DALI_READ_MEMORY_LOCATION) };
+    if (!select_location(request)) {
+        *status = MEMORY_BANK_BUS_ERROR;
+        return 0;
+    }
+    for (uint_fast8_t i = 0; i < request->count; i++) {
+        struct dali_rx_frame reply;
+        if (!bus_query(frame, &reply)) {
+            *status = MEMORY_BANK_BUS_ERROR;
+            return i;
+        }
+        if (reply.status != DALI_OK || reply.length != 8) {
+            *status = MEMORY_BANK_NO_ANSWER;
+            return i;
+        }
+        result[MEMORY_BANK_IDX_DATA + i] = reply.data;
+    }
+    return request->count;
+}
+
+static uint_fast8_t write_locations(const struct memory_bank_request* request, enum memory_bank_status* status)
+{
+    if (!select_location(request) ||
+        !send_command(request, addressed_command(request->address, DALI_ENABLE_WRITE_MEMORY), true)) {
+        *status = MEMORY_BANK_BUS_ERROR;
+        return 0;
+    }
+    for (uint_fast8_t i = 0; i < request->count; i++) {
+        if (!send_command(request, DALI_WRITE_MEMORY_LOCATION_NO_REPLY | request->data[i], false)) {
+            *status = MEMORY_BANK_BUS_ERROR;
+            return 0;
+        }
+    }
+    const uint_fast8_t n_read = read_locations(request, status);
+    for (uint_fast8_t i = 0; i < n_read; i++) {
+        if (result[MEMORY_BANK_IDX_DATA + i] != request->data[i]) {
+            *status = MEMORY_BANK_VERIFY_FAILED;
+            return i;
+        }
+    }
+    return n_read;
+}
+
+void memory_bank_execute(const struct memory_bank_request* request)
+{
+    enum memory_bank_status status = MEMORY_BANK_OK;
+    result[0] = request->address;
+    result[1] = request->bank;
+    result[2] = request->location;
+    if (request->write) {
+        result[MEMORY_BANK_IDX_COUNT] = write_locations(request, &status);
+        result[MEMORY_BANK_IDX_STATUS] = status;
+        serial_print_block(SERIAL_REPORT_MEMORY_WRITE, result, MEMORY_BANK_IDX_DATA);
+    } else {
+        result[MEMORY_BANK_IDX_COUNT] = read_locations(request, &status);
+        result[MEMORY_BANK_IDX_STATUS] = status;
+        serial_print_block(
+            SERIAL_REPORT_MEMORY_READ, result, MEMORY_BANK_IDX_DATA + result[MEMORY_BANK_IDX_COUNT]);
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <stdbool.h>               // for bool
+#include <stdint.h>                // for uint8_t
+#include "dali_101_lpc/dali_101.h" // for dali_frame_type
+
+#define MEMORY_BANK_MAX_READ (64U)
+#define MEMORY_BANK_MAX_WRITE (16U)
+// DTR0 wraps after the last location of a bank
+#define MEMORY_BANK_LOCATIONS (0x100U)
+
+/**
+ * @brief Parameters for a bulk memory bank access
+ *
+ */
+struct memory_bank_request {
+    enum dali_frame_type forward_type;   /**< frame type used for commands */
+    enum dali_frame_type query_type;     /**< frame type used for queries */
+    bool write;                          /**< write and verify `data`, otherwise read `count` bytes */
+    uint8_t address;                     /**< short address of the control gear */
+    uint8_t bank;                        /**< memory bank */
+    uint8_t location;                    /**< first memory location */
+    uint8_t count;                       /**< number of bytes to read or write */
+    uint8_t data[MEMORY_BANK_MAX_WRITE]; /**< data to write */
+};
+
+/**
+ * @brief Read or write a block of memory locations and report the result
+ *
+ * @param request memory bank access parameters
+ */
+void memory_bank_execute(const struct memory_bank_request* request);
@@ -0,0 +1,80 @@
+#include <stdbool.h> // for bool, false, true
+#include <stdint.h>  // for uint8_t, uint16_t, uint32_t, uint64_t
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "dali_101_lpc/dali_101.h"
+#include "serial.h"
+#include "meter.h"
+
+#define METER_PERMILLE (1000U)
+#define METER_REPORT_SIZE (20U)
+
+static struct _meter {
+    TickType_t window;
+    TickType_t next_report;
+    uint16_t peak_permille;
+    bool restart;
+} meter = { 0 };
+
+bool meter_configure(uint32_t window_ms)
+{
+    if (window_ms > METER_MAX_WINDOW_MS) {
+        return false;
+    }
+    taskENTER_CRITICAL();
+    meter.window = pdMS_TO_TICKS(window_ms);
+    meter.next_report = xTaskGetTickCount() + meter.window;
+    meter.peak_permille = 0;
+    meter.restart = true;
+    taskEXIT_CRITICAL();
+    return true;
+}
+
+static uint16_t get_permille(const struct dali_bus_time* time)
+{
+    const uint64_t busy_us = (uint64_t)time->foreign_us + time->transmit_us;
+    const uint64_t total_us = busy_us + time->idle_us + time->failure_us;
+    if (total_us == 0) {
+        return 0;
+    }
+    return (busy_us * METER_PERMILLE) / total_us;
+}
+
+void meter_run(void)
+{
+    if (!meter.window) {
+        return;
+    }
+    struct dali_bus_time time;
+    if (meter.restart) {
+        // discard the time accumulated before the first window
+        dali_101_get_bus_time(&time);
+        meter.restart = false;
+        return;
+    }
+    const TickType_t now = xTaskGetTickCount();
+    if ((int32_t)(now - meter.next_report) < 0) {
+        return;
+    }
+    meter.next_report += meter.window;
+    if ((int32_t)(now - meter.next_report) >= 0) {
+        meter.next_report = now + meter.window;
+    }
+    dali_101_get_bus_time(&time);
+    const uint16_t permille = get_permille(&time);
+    if (permille > meter.peak_permille) {
+        meter.peak_permille = permille;
+    }
+    uint8_t result[METER_REPORT_SIZE];
+    serial_put_uint32(&result[0], time.idle_us);
+    serial_put_uint32(&result[4], time.foreign_us);
+    serial_put_uint32(&result[8], time.transmit_us);
+    serial_put_uint32(&result[12], time.failure_us);
+    result[16] = permille >> 8U;
+    result[17] = permille;
+    result[18] = meter.peak_permille >> 8U;
+    result[19] = meter.peak_permille;
+    serial_print_block(SERIAL_REPORT_UTILISATION, result, sizeof(result));
+}
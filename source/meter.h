@@ -0,0 +1,21 @@
+#pragma once
+#include <stdbool.h> // for bool
+#include <stdint.h>  // for uint32_t
+
+// the bus times are accumulated in 32 bit microsecond counters, which overflow after 4294 s
+#define METER_MAX_WINDOW_MS (3600000U)
+
+/**
+ * @brief Start or stop the bus utilisation meter, resets the peak utilisation
+ *
+ * @param window_ms length of the measurement window in milliseconds, 0 - stop the meter
+ * @return `true` - meter was configured
+ * @return `false` - window is longer than METER_MAX_WINDOW_MS
+ */
+bool meter_configure(uint32_t window_ms);
+
+/**
+ * @brief Output the utilisation when the window is complete. Must be called from the main task.
+ *
+ */
+void meter_run(void);
@@ -0,0 +1,47 @@
+#include <stdbool.h> // for bool, false, true
+#include <stdint.h>  // for uint8_t, uint32_t, uint_fast8_t
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "dali_101_lpc/dali_101.h"
+#include "responder.h"
+
+// the table is read by the receiver task, which has the higher priority,
+// changes are made inside critical sections
+static struct _responder {
+    struct responder_entry entry[RESPONDER_MAX_ENTRIES];
+    uint_fast8_t n_entries;
+} responder = { 0 };
+
+void responder_clear(void)
+{
+    taskENTER_CRITICAL();
+    responder.n_entries = 0;
+    taskEXIT_CRITICAL();
+}
+
+bool responder_add(const struct responder_entry entry)
+{
+    bool result = false;
+    taskENTER_CRITICAL();
+    if (responder.n_entries < RESPONDER_MAX_ENTRIES) {
+        responder.entry[responder.n_entries++] = entry;
+        result = true;
+    }
+    taskEXIT_CRITICAL();
+    return result;
+}
+
+bool responder_match(const struct dali_rx_frame* frame, struct dali_tx_frame* reply, uint32_t* delay_us)
+{
+    for (uint_fast8_t i = 0; i < responder.n_entries; i++) {
+        const struct responder_entry* entry = &responder.entry[i];
+        if (entry->length == frame->length && ((frame->data ^ entry->value) & entry->mask) == 0) {
+            reply->data = entry->backframe;
+            *delay_us = entry->delay_us;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <stdbool.h>               // for bool
+#include <stdint.h>                // for uint8_t, uint16_t, uint32_t
+#include "dali_101_lpc/dali_101.h" // for dali_rx_frame, dali_tx_frame
+
+#define RESPONDER_MAX_ENTRIES (8U)
+#define RESPONDER_MAX_DELAY_US (19500U)
+
+/**
+ * @brief Backward frame that answers a forward frame pattern
+ *
+ */
+struct responder_entry {
+    uint32_t value;    /**< expected forward frame data */
+    uint32_t mask;     /**< bits of the forward frame to compare */
+    uint8_t length;    /**< number of data bits of the forward frame */
+    uint8_t backframe; /**< backward frame data */
+    uint16_t delay_us; /**< delay of the backward frame, 0 - default settling time */
+};
+
+/**
+ * @brief Delete all entries, no more automatic responses are sent
+ *
+ */
+void responder_clear(void);
+
+/**
+ * @brief Add an entry to the end of the responder table
+ *
+ * @param entry entry to add
+ * @return `true` - entry was added
+ * @return `false` - table is full
+ */
+bool responder_add(struct responder_entry entry);
+
+/**
+ * @brief Look up the response for a received frame, the first matching entry is used
+ *
+ * Called from the receiver task, see `dali_101_responder`.
+ */
+bool responder_match(const struct dali_rx_frame* frame, struct dali_tx_frame* reply, uint32_t* delay_us);
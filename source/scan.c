@@ -0,0 +1,62 @@
+#include <stdbool.h> // for bool
+#include <stdint.h>  // for uint8_t, uint64_t, uint_fast8_t
+
+#include "dali_101_lpc/dali_101.h"
+#include "bus.h"
+#include "serial.h"
+#include "scan.h"
+
+#define SCAN_ADDRESSES (64U)
+#define SCAN_IDX_OPCODE (0U)
+#define SCAN_IDX_ANSWERED (1U)
+#define SCAN_IDX_FAILED (SCAN_IDX_ANSWERED + SERIAL_BITMAP_SIZE)
+#define SCAN_IDX_VALUES (SCAN_IDX_FAILED + SERIAL_BITMAP_SIZE)
+
+static uint8_t result[SCAN_IDX_VALUES + SCAN_ADDRESSES];
+
+static uint32_t query_data(uint_fast8_t address, uint8_t opcode)
+{
+    return ((((uint32_t)address << 1U) | 1U) << 8U) | opcode;
+}
+
+static void scan_opcode(const struct scan_request* request, uint8_t opcode)
+{
+    uint64_t answered = 0;
+    uint64_t failed = 0;
+    uint_fast8_t n_values = 0;
+
+    for (uint_fast8_t address = 0; address < SCAN_ADDRESSES; address++) {
+        const uint64_t mask = ((uint64_t)1 << address);
+        if (!(request->addresses & mask)) {
+            continue;
+        }
+        const struct dali_tx_frame frame = { .type = request->type,
+                                             .length = 16,
+                                             .data = query_data(address, opcode) };
+        struct dali_rx_frame reply;
+        if (!bus_query(frame, &reply)) {
+            failed |= mask;
+            continue;
+        }
+        if (reply.status == DALI_TIMEOUT) {
+            continue;
+        }
+        if (reply.status == DALI_OK && reply.length == 8) {
+            answered |= mask;
+            result[SCAN_IDX_VALUES + n_values++] = reply.data;
+            continue;
+        }
+        failed |= mask;
+    }
+    result[SCAN_IDX_OPCODE] = opcode;
+    serial_put_bitmap(&result[SCAN_IDX_ANSWERED], answered);
+    serial_put_bitmap(&result[SCAN_IDX_FAILED], failed);
+    serial_print_block(SERIAL_REPORT_SCAN, result, SCAN_IDX_VALUES + n_values);
+}
+
+void scan_execute(const struct scan_request* request)
+{
+    for (uint_fast8_t i = 0; i < request->opcode_count; i++) {
+        scan_opcode(request, request->opcode[i]);
+    }
+}
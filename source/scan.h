@@ -0,0 +1,23 @@
+#pragma once
+#include <stdint.h>                // for uint8_t, uint64_t
+#include "dali_101_lpc/dali_101.h" // for dali_frame_type
+
+#define SCAN_MAX_OPCODES (4U)
+
+/**
+ * @brief Parameters for an address scan
+ *
+ */
+struct scan_request {
+    uint64_t addresses;               /**< bit n set: query short address n */
+    enum dali_frame_type type;        /**< frame type used for the queries */
+    uint8_t opcode[SCAN_MAX_OPCODES]; /**< opcodes to query */
+    uint8_t opcode_count;             /**< number of opcodes */
+};
+
+/**
+ * @brief Query all requested addresses and report one result per opcode
+ *
+ * @param request scan parameters
+ */
+void scan_execute(const struct scan_request* request);
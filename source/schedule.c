@@ -0,0 +1,148 @@
+#include <stdbool.h> // for bool, false, true
+#include <stdint.h>  // for uint8_t, uint32_t, int32_t, uint_fast8_t
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "dali_101_lpc/dali_101.h"
+#include "bus.h"
+#include "serial.h"
+#include "schedule.h"
+
+#define SCHEDULE_ENTRY_SIZE (13U)
+#define SCHEDULE_QUERY_FLAG (0x80U)
+#define SCHEDULE_BACK_TO_BACK_PRIORITY (6U)
+
+struct _job {
+    struct dali_tx_frame frame;
+    TickType_t period;
+    TickType_t jitter;
+    TickType_t next_start;
+    TickType_t due;
+    bool active;
+};
+
+static struct _job jobs[SCHEDULE_MAX_JOBS];
+
+static bool is_query(enum dali_frame_type type)
+{
+    return (type >= DALI_FRAME_QUERY_1 && type <= DALI_FRAME_QUERY_5);
+}
+
+static uint8_t get_priority(enum dali_frame_type type)
+{
+    if (is_query(type)) {
+        return SCHEDULE_QUERY_FLAG | (type - DALI_FRAME_QUERY_1 + 1U);
+    }
+    if (type == DALI_FRAME_BACK_TO_BACK) {
+        return SCHEDULE_BACK_TO_BACK_PRIORITY;
+    }
+    return type - DALI_FRAME_FORWARD_1 + 1U;
+}
+
+static TickType_t random_delay(TickType_t jitter)
+{
+    static uint32_t state = 0x2545F491UL;
+    if (jitter == 0) {
+        return 0;
+    }
+    // xorshift32
+    state ^= state << 13U;
+    state ^= state >> 17U;
+    state ^= state << 5U;
+    return state % (jitter + 1U);
+}
+
+bool schedule_add(uint8_t id, struct dali_tx_frame frame, uint32_t period_ms, uint16_t jitter_ms)
+{
+    if (id >= SCHEDULE_MAX_JOBS || frame.type == DALI_FRAME_NONE || period_ms == 0 || jitter_ms >= period_ms) {
+        return false;
+    }
+    const TickType_t now = xTaskGetTickCount();
+    taskENTER_CRITICAL();
+    jobs[id] = (struct _job){ .frame = frame,
+                              .period = pdMS_TO_TICKS(period_ms),
+                              .jitter = pdMS_TO_TICKS(jitter_ms),
+                              .next_start = now,
+                              .due = now,
+                              .active = true };
+    taskEXIT_CRITICAL();
+    return true;
+}
+
+bool schedule_remove(uint8_t id)
+{
+    if (id >= SCHEDULE_MAX_JOBS || !jobs[id].active) {
+        return false;
+    }
+    jobs[id].active = false;
+    return true;
+}
+
+void schedule_list(void)
+{
+    uint8_t result[SCHEDULE_MAX_JOBS * SCHEDULE_ENTRY_SIZE];
+    uint_fast8_t length = 0;
+    for (uint_fast8_t id = 0; id < SCHEDULE_MAX_JOBS; id++) {
+        taskENTER_CRITICAL();
+        const struct _job job = jobs[id];
+        taskEXIT_CRITICAL();
+        if (!job.active) {
+            continue;
+        }
+        const uint32_t jitter_ms = pdTICKS_TO_MS(job.jitter);
+        result[length++] = id;
+        result[length++] = get_priority(job.frame.type);
+        serial_put_uint32(&result[length], pdTICKS_TO_MS(job.period));
+        length += 4;
+        result[length++] = jitter_ms >> 8U;
+        result[length++] = jitter_ms;
+        result[length++] = job.frame.length;
+        serial_put_uint32(&result[length], job.frame.data);
+        length += 4;
+    }
+    serial_print_block(SERIAL_REPORT_JOB_LIST, result, length);
+}
+
+static void report_result(uint8_t id, const struct dali_rx_frame* frame)
+{
+    uint8_t result[6] = { id, (frame->status > DALI_OK) ? frame->status : frame->length };
+    serial_put_uint32(&result[2], frame->data);
+    serial_print_block(SERIAL_REPORT_JOB_RESULT, result, sizeof(result));
+}
+
+static void execute(uint8_t id, const struct dali_tx_frame frame)
+{
+    struct dali_rx_frame result = { .status = DALI_ERROR_CAN_NOT_PROCESS };
+    if (is_query(frame.type)) {
+        bus_query(frame, &result);
+    } else {
+        bus_send(frame, &result);
+    }
+    report_result(id, &result);
+}
+
+bool schedule_run(void)
+{
+    const TickType_t now = xTaskGetTickCount();
+    for (uint_fast8_t id = 0; id < SCHEDULE_MAX_JOBS; id++) {
+        taskENTER_CRITICAL();
+        struct _job* job = &jobs[id];
+        const bool is_due = job->active && ((int32_t)(now - job->due) >= 0);
+        const struct dali_tx_frame frame = job->frame;
+        if (is_due) {
+            job->next_start += job->period;
+            // skip periods we missed, do not try to catch up
+            if ((int32_t)(now - job->next_start) >= 0) {
+                job->next_start = now + job->period;
+            }
+            job->due = job->next_start + random_delay(job->jitter);
+        }
+        taskEXIT_CRITICAL();
+        if (is_due) {
+            execute(id, frame);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <stdbool.h>               // for bool
+#include <stdint.h>                // for uint8_t, uint32_t
+#include "dali_101_lpc/dali_101.h" // for dali_tx_frame
+
+#define SCHEDULE_MAX_JOBS (4U)
+
+/**
+ * @brief Add or replace a periodic job
+ *
+ * @param id job id, 0..SCHEDULE_MAX_JOBS-1
+ * @param frame frame to send, query frame types report the reply
+ * @param period_ms period in milliseconds
+ * @param jitter_ms maximum random delay added to each start, in milliseconds
+ * @return `true` - job was added
+ * @return `false` - bad parameter
+ */
+bool schedule_add(uint8_t id, struct dali_tx_frame frame, uint32_t period_ms, uint16_t jitter_ms);
+
+/**
+ * @brief Remove a periodic job
+ *
+ * @param id job id
+ * @return `true` - job was removed
+ * @return `false` - no such job
+ */
+bool schedule_remove(uint8_t id);
+
+/**
+ * @brief Report all active jobs
+ *
+ */
+void schedule_list(void);
+
+/**
+ * @brief Execute the next job that is due. Must be called from the main task.
+ *
+ * @return `true` - a job was executed
+ * @return `false` - no job was due
+ */
+bool schedule_run(void);
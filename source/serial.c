@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <ctype.h>   // isxdigit
 #include <stdlib.h>  // strtoul
 #include <stdint.h>  // uintXX_t
 #include <stdbool.h> // for bool
@@ -7,6 +8,7 @@
 #include "FreeRTOS.h" // tasks and queues
 #include "task.h"
 #include "queue.h"
+#include "semphr.h"
 
 #include "lpc11xx.h" // UART registers
 #include "bitfields.h"
@@ -15,9 +17,18 @@
 #include "board/led.h"
 #include "board/board.h" // irq priorities
 #include "version.h"
+#include "schedule.h"
+#include "responder.h"
+#include "gear.h"
+#include "filter.h"
+#include "echo.h"
+#include "meter.h"
+#include "traffic.h"
+#include "capture.h"
+#include "settings.h"
 #include "serial.h"
 
-#define SERIAL_BUFFER_SIZE 20
+#define SERIAL_BUFFER_SIZE 64
 #define SERIAL_IDX_CMD 0
 #define SERIAL_IDX_ARG 1
 #define SERIAL_CMD_QUERY 'Q'
@@ -29,13 +40,96 @@
 #define SERIAL_CMD_NEXT_SEQ 'N'
 #define SERIAL_CMD_EXECUTE_SEQ 'X'
 #define SERIAL_CMD_CORRUPT 'I'
+#define SERIAL_CMD_SCAN 'L'
+#define SERIAL_CMD_COMMISSION 'P'
+#define SERIAL_CMD_MEMORY_BANK 'M'
+#define SERIAL_CMD_JOB 'J'
+#define SERIAL_CHAR_READ 'r'
+#define SERIAL_CHAR_WRITE 'w'
+#define SERIAL_CHAR_JOB_SEND 's'
+#define SERIAL_CHAR_JOB_QUERY 'q'
+#define SERIAL_CHAR_JOB_DELETE 'd'
+#define SERIAL_CHAR_JOB_LIST 'l'
+#define SERIAL_CMD_MACRO 'U'
+#define SERIAL_CHAR_MACRO_CLEAR 'c'
+#define SERIAL_CHAR_MACRO_ADD 'a'
+#define SERIAL_CHAR_MACRO_EXECUTE 'x'
+#define SERIAL_CMD_CONDITION 'K'
+#define SERIAL_CMD_RESPONDER 'H'
+#define SERIAL_CHAR_RESPONDER_CLEAR 'c'
+#define SERIAL_CHAR_RESPONDER_ADD 'a'
+#define SERIAL_CMD_GEAR 'V'
+#define SERIAL_CHAR_GEAR_CLEAR 'c'
+#define SERIAL_CHAR_GEAR_ADD 'a'
+#define SERIAL_CHAR_GEAR_REPORT 'd'
+#define SERIAL_CMD_FILTER 'G'
+#define SERIAL_CHAR_FILTER_CLEAR 'c'
+#define SERIAL_CHAR_FILTER_INCLUDE 'i'
+#define SERIAL_CHAR_FILTER_EXCLUDE 'e'
+#define SERIAL_CHAR_FILTER_REPORT 'r'
+#define SERIAL_CMD_OPTION 'O'
+#define SERIAL_CHAR_OPTION_ECHO 'e'
+#define SERIAL_CHAR_OPTION_CACHE 'c'
+#define SERIAL_CHAR_OPTION_MERGE 'm'
+#define SERIAL_CHAR_OPTION_TIMESTAMP 't'
+#define SERIAL_CMD_STATISTICS 'Z'
+#define SERIAL_CMD_URGENT '!'
+#define SERIAL_CMD_TIME 'T'
+#define SERIAL_CHAR_TIME_READ 'r'
+#define SERIAL_CHAR_TIME_SEND 's'
+#define SERIAL_CHAR_TIME_QUERY 'q'
+#define SERIAL_CHAR_TIME_SYNC 'c'
+#define SERIAL_CHAR_TIME_ALIGN 'a'
+#define SERIAL_CMD_TRIGGER '^'
+#define SERIAL_CHAR_TRIGGER_SEND 's'
+#define SERIAL_CHAR_TRIGGER_BACKFRAME 'y'
+#define SERIAL_CHAR_TRIGGER_SEQUENCE 'x'
+#define SERIAL_CMD_CAPTURE '%'
+#define SERIAL_CHAR_CAPTURE_STATUS 's'
+#define SERIAL_CHAR_CAPTURE_MATCH 'm'
+#define SERIAL_CMD_CALIBRATE '&'
+#define SERIAL_CHAR_CALIBRATE_RX 'r'
+#define SERIAL_CHAR_CALIBRATE_FOREIGN 'f'
+#define SERIAL_CHAR_CALIBRATE_APPLY 'a'
+#define SERIAL_CHAR_CALIBRATE_SAVE 'w'
+#define SERIAL_CHAR_CALIBRATE_DEFAULTS 'd'
+#define SERIAL_CHAR_CALIBRATE_TX 't'
+#define SERIAL_CHAR_CALIBRATE_STATISTICS 's'
+#define SERIAL_CMD_SETTLING '$'
+#define SERIAL_CHAR_SETTLING_PROFILE 'p'
+#define SERIAL_CHAR_SETTLING_TIMES 't'
+#define SERIAL_CHAR_SETTLING_REPORT 'q'
+#define SERIAL_CHAR_SETTLING_START 's'
+#define SERIAL_CHAR_STATISTICS_UTILISATION 'u'
+#define SERIAL_CHAR_STATISTICS_ADDRESSES 'a'
+#define SERIAL_CHAR_STATISTICS_MERGE 'm'
+#define SERIAL_CHAR_STATISTICS_STACK 's'
+#define SERIAL_CHAR_STEP_SEND 's'
+#define SERIAL_CHAR_STEP_QUERY 'q'
+#define SERIAL_CHAR_STEP_REPEAT 'r'
+#define SERIAL_CHAR_STEP_BACKFRAME 'y'
+#define SERIAL_CHAR_PARAMETER '<'
+#define SERIAL_CHAR_EXPECT '='
 #define SERIAL_CHAR_TWICE '+'
+#define SERIAL_CHAR_RANGE '-'
+#define SERIAL_CHAR_BYPASS '#'
 #define SERIAL_CHAR_EOL 0x0d
+#define SERIAL_SEQUENCE_DEFAULT_PRIORITY 1
 
 #define SERIAL_TASK_STACKSIZE (3U * configMINIMAL_STACK_SIZE)
 #define SERIAL_PRIORITY (tskIDLE_PRIORITY + 3U)
 #define SERIAL_QUEUE_LENGTH (4U)
 #define SERIAL_NOTIFY_PROCESSS (1U)
+#define SERIAL_LEVEL_FRAME_LENGTH (16U)
+#define SERIAL_ADDRESS_SELECTOR (0x0100U)
+#define SERIAL_GROUP_ADDRESS (0x80U)
+#define SERIAL_MERGE_REPORT_SIZE (8U)
+#define SERIAL_URGENT_WAIT_MS (200U)
+#define SERIAL_URGENT_REPORT_SIZE (4U)
+#define SERIAL_TIME_REPORT_SIZE (4U)
+#define SERIAL_SYNC_REPORT_SIZE (12U)
+#define SERIAL_MAX_DRIFT_PPB (1000000L)
+#define SERIAL_PPB (1000000000LL)
 
 #define SERIAL_BAUDRATE_500000
 
@@ -52,10 +146,29 @@
 #define SERIAL_DLL (4U)
 #endif
 
+enum serial_timestamp {
+    SERIAL_TIMESTAMP_MS = 0, /**< milliseconds since start up */
+    SERIAL_TIMESTAMP_DEVICE, /**< device time in microseconds */
+    SERIAL_TIMESTAMP_HOST,   /**< device time aligned to the host clock in microseconds */
+    SERIAL_TIMESTAMPS,
+};
+
 struct _serial {
     char* cmd_buffer;
     TaskHandle_t task_handle;
     QueueHandle_t queue_handle;
+    SemaphoreHandle_t output_lock;
+    struct serial_request pending[SERIAL_QUEUE_LENGTH];
+    uint32_t queued;
+    uint32_t merged;
+    bool merge;
+    enum serial_timestamp timestamp;
+    uint32_t align_device_us;
+    uint32_t align_host_us;
+    int32_t align_drift_ppb;
+    volatile uint32_t receive_time;
+    volatile bool urgent;
+    uint8_t sequences;
 } serial = { 0 };
 
 void serial_print_head(void)
@@ -65,17 +178,63 @@ void serial_print_head(void)
     printf("\r\n");
 }
 
+// the drift correction is valid for about 35 minutes around the alignment point
+static uint32_t get_timestamp(uint32_t ms, uint32_t time_us)
+{
+    switch (serial.timestamp) {
+    case SERIAL_TIMESTAMP_DEVICE:
+        return time_us;
+    case SERIAL_TIMESTAMP_HOST: {
+        const int32_t elapsed_us = time_us - serial.align_device_us;
+        const int32_t correction_us = ((int64_t)elapsed_us * serial.align_drift_ppb) / SERIAL_PPB;
+        return serial.align_host_us + elapsed_us + correction_us;
+    }
+    default:
+        return ms;
+    }
+}
+
+// the main task and the serial task both output messages, a message is never interrupted by another one
 void serial_print_frame(const struct dali_rx_frame frame)
 {
     const char c = frame.loopback ? '>' : ':';
     const uint8_t length = (frame.status > DALI_OK) ? frame.status : frame.length;
-    printf("{%08lx%c%02x %08lx}\r\n", frame.timestamp, c, length, frame.data);
+    xSemaphoreTake(serial.output_lock, portMAX_DELAY);
+    printf("{%08lx%c%02x %08lx}\r\n", get_timestamp(frame.timestamp, frame.time_us), c, length, frame.data);
+    xSemaphoreGive(serial.output_lock);
+}
+
+void serial_print_block(enum serial_report code, const uint8_t* data, size_t length)
+{
+    xSemaphoreTake(serial.output_lock, portMAX_DELAY);
+    printf("{%08lx#%02x ", get_timestamp(pdTICKS_TO_MS(xTaskGetTickCount()), dali_101_get_time()), code);
+    for (size_t i = 0; i < length; i++) {
+        printf("%02x", data[i]);
+    }
+    printf("}\r\n");
+    xSemaphoreGive(serial.output_lock);
+}
+
+void serial_put_bitmap(uint8_t* buffer, uint64_t bitmap)
+{
+    for (size_t i = 0; i < SERIAL_BITMAP_SIZE; i++) {
+        buffer[i] = bitmap >> (8U * (SERIAL_BITMAP_SIZE - 1U - i));
+    }
+}
+
+void serial_put_uint32(uint8_t* buffer, uint32_t value)
+{
+    buffer[0] = value >> 24U;
+    buffer[1] = value >> 16U;
+    buffer[2] = value >> 8U;
+    buffer[3] = value;
 }
 
 static void print_parameter_error(void)
 {
     const struct dali_rx_frame frame = {
         .timestamp = xTaskGetTickCount(),
+        .time_us = dali_101_get_time(),
         .status = DALI_ERROR_BAD_COMMAND,
     };
     serial_print_frame(frame);
@@ -85,6 +244,7 @@ static void print_queue_full_error(void)
 {
     const struct dali_rx_frame frame = {
         .timestamp = xTaskGetTickCount(),
+        .time_us = dali_101_get_time(),
         .status = DALI_ERROR_QUEUE_FULL,
     };
     serial_print_frame(frame);
@@ -148,61 +308,505 @@ static bool data_illegal(uint64_t data, uint8_t length)
     return (data >= upper_limit);
 }
 
-static void queue_frame(const struct dali_tx_frame frame)
+// a direct arc power control frame is superseded by the next one for the same address
+static bool is_level_frame(const struct serial_request* request)
 {
-    if (xQueueSendToBack(serial.queue_handle, &frame, 0) == errQUEUE_FULL) {
+    const struct dali_tx_frame* frame = &request->frame;
+    return request->job == SERIAL_JOB_FRAME && !frame->sequence && frame->type >= DALI_FRAME_FORWARD_1 &&
+           frame->type <= DALI_FRAME_FORWARD_5 && frame->length == SERIAL_LEVEL_FRAME_LENGTH && !frame->repeat &&
+           !(frame->data & SERIAL_ADDRESS_SELECTOR);
+}
+
+static bool is_short_address(uint8_t address)
+{
+    return address < SERIAL_GROUP_ADDRESS;
+}
+
+// The queue offers no access to waiting requests, take them out and put them back.
+// A queued frame is replaced only if the frames behind it address other control gear.
+static bool merge_level_frame(const struct serial_request* request)
+{
+    const uint8_t address = request->frame.data >> 8U;
+    bool merged = false;
+    UBaseType_t count = 0;
+    vTaskSuspendAll();
+    while (count < SERIAL_QUEUE_LENGTH && xQueueReceive(serial.queue_handle, &serial.pending[count], 0) == pdPASS) {
+        count++;
+    }
+    for (UBaseType_t i = count; i-- > 0;) {
+        struct dali_tx_frame* queued = &serial.pending[i].frame;
+        if (!is_level_frame(&serial.pending[i])) {
+            break;
+        }
+        const uint8_t queued_address = queued->data >> 8U;
+        if (queued_address == address) {
+            if (queued->type == request->frame.type) {
+                queued->data = request->frame.data;
+                merged = true;
+            }
+            break;
+        }
+        if (!is_short_address(queued_address) || !is_short_address(address)) {
+            break;
+        }
+    }
+    for (UBaseType_t i = 0; i < count; i++) {
+        xQueueSendToBack(serial.queue_handle, &serial.pending[i], 0);
+    }
+    xTaskResumeAll();
+    return merged;
+}
+
+// the driver copies the bit sequence when the main task hands the frame over
+static bool sends_sequence(const struct serial_request* request)
+{
+    return (request->job == SERIAL_JOB_FRAME && request->frame.sequence) ||
+           (request->job == SERIAL_JOB_TRIGGERED_FRAME && request->triggered_frame.frame.sequence);
+}
+
+static void queue_request(const struct serial_request request)
+{
+    if (serial.merge && is_level_frame(&request) && merge_level_frame(&request)) {
+        serial.merged++;
+        return;
+    }
+    if (xQueueSendToBack(serial.queue_handle, &request, 0) == errQUEUE_FULL) {
         print_queue_full_error();
+        return;
+    }
+    serial.queued++;
+    if (sends_sequence(&request)) {
+        serial.sequences++;
+    }
+}
+
+static void print_merge_report(bool reset)
+{
+    uint8_t result[SERIAL_MERGE_REPORT_SIZE];
+    serial_put_uint32(&result[0], serial.queued);
+    serial_put_uint32(&result[4], serial.merged);
+    if (reset) {
+        serial.queued = 0;
+        serial.merged = 0;
+    }
+    serial_print_block(SERIAL_REPORT_MERGE, result, sizeof(result));
+}
+
+// free stack of each task in words, the lowest value since the start
+static void print_stack_report(void)
+{
+    static const char* const task_names[] = { "MAIN", "SERIAL", "DALI RX", "Tmr Svc", "IDLE" };
+    uint8_t result[2U * (sizeof(task_names) / sizeof(task_names[0]))];
+    for (size_t i = 0; i < sizeof(task_names) / sizeof(task_names[0]); i++) {
+        const TaskHandle_t handle = xTaskGetHandle(task_names[i]);
+        const UBaseType_t free_words = handle ? uxTaskGetStackHighWaterMark(handle) : 0;
+        result[2U * i] = free_words >> 8U;
+        result[2U * i + 1U] = free_words;
+    }
+    serial_print_block(SERIAL_REPORT_STACK, result, sizeof(result));
+}
+
+static void queue_frame(const struct dali_tx_frame frame)
+{
+    const struct serial_request request = { .job = SERIAL_JOB_FRAME, .frame = frame };
+    queue_request(request);
+}
+
+static char* skip_blanks(char* argument_buffer)
+{
+    while (*argument_buffer == ' ') {
+        argument_buffer++;
+    }
+    return argument_buffer;
+}
+
+static bool parse_frame(char* argument_buffer, char** end_of_read, bool query, struct dali_tx_frame* frame)
+{
+    const uint8_t priority = strtoul(argument_buffer, end_of_read, 16);
+    const uint8_t length = strtoul(*end_of_read, end_of_read, 16);
+    const char twice_indicator = **end_of_read;
+    if (twice_indicator) {
+        (*end_of_read)++;
+    }
+    const uint64_t data = strtoull(*end_of_read, end_of_read, 16);
+
+    if (priority_or_length_illegal(priority, length) || data_illegal(data, length)) {
+        return false;
+    }
+    *frame = (struct dali_tx_frame){ .type = query ? get_query_type(priority) : get_forward_type(priority),
+                                     .repeat = (twice_indicator == SERIAL_CHAR_TWICE) ? 1 : 0,
+                                     .length = length,
+                                     .data = data };
+    return true;
+}
+
+static bool parse_backframe(char* argument_buffer, char** end_of_read, struct dali_tx_frame* frame)
+{
+    const uint64_t data = strtoull(argument_buffer, end_of_read, 16);
+
+    if (data > 0xFF) {
+        return false;
+    }
+    *frame = (struct dali_tx_frame){ .type = DALI_FRAME_BACKWARD, .repeat = 0, .length = 8, .data = data };
+    return true;
+}
+
+static bool parse_repeated_frame(char* argument_buffer, char** end_of_read, struct dali_tx_frame* frame)
+{
+    const uint8_t priority = strtoul(argument_buffer, end_of_read, 16);
+    const uint8_t repeat = strtoul(*end_of_read, end_of_read, 16);
+    const uint8_t length = strtoul(*end_of_read, end_of_read, 16);
+    const uint64_t data = strtoull(*end_of_read, end_of_read, 16);
+    if (priority_or_length_illegal(priority, length) || data_illegal(data, length)) {
+        return false;
     }
+    *frame = (struct dali_tx_frame){
+        .type = get_forward_type(priority), .repeat = repeat, .length = length, .data = data
+    };
+    return true;
 }
 
 static void query_command(char* argument_buffer)
 {
     char* end_of_read;
-    const uint8_t priority = strtoul(argument_buffer, &end_of_read, 16);
-    const uint8_t length = strtoul(end_of_read, &end_of_read, 16);
-    const char twice_indicator = *end_of_read++;
-    const uint64_t data = strtoull(end_of_read, &end_of_read, 16);
+    struct dali_tx_frame frame;
+    if (!parse_frame(argument_buffer, &end_of_read, true, &frame)) {
+        print_parameter_error();
+        return;
+    }
+    const bool bypass = (*skip_blanks(end_of_read) == SERIAL_CHAR_BYPASS);
+    if (!cache_is_cached(&frame)) {
+        queue_frame(frame);
+        return;
+    }
+    const struct serial_request request = { .job = SERIAL_JOB_CACHED_QUERY,
+                                            .cached_query = { .frame = frame, .bypass = bypass } };
+    queue_request(request);
+}
 
-    if (priority_or_length_illegal(priority, length) || data_illegal(data, length)) {
+static void send_forward_frame_command(char* argument_buffer)
+{
+    char* end_of_read;
+    struct dali_tx_frame frame;
+    if (!parse_frame(argument_buffer, &end_of_read, false, &frame)) {
         print_parameter_error();
         return;
     }
-    const struct dali_tx_frame frame = { .type = get_query_type(priority),
-                                         .repeat = (twice_indicator == SERIAL_CHAR_TWICE) ? 1 : 0,
-                                         .length = length,
-                                         .data = data };
     queue_frame(frame);
 }
 
-static void send_forward_frame_command(char* argument_buffer)
+static uint8_t flush_queue(void)
+{
+    uint8_t count = 0;
+    while (xQueueReceive(serial.queue_handle, &serial.pending[0], 0) == pdPASS) {
+        if (sends_sequence(&serial.pending[0])) {
+            serial.sequences--;
+        }
+        count++;
+    }
+    return count;
+}
+
+// The frame on the bus is completed, the main task does not start another one while the urgent
+// frame waits. After the wait limit a frame that waits for the bus is replaced, e.g. while the
+// bus is in failure state. A frame on the bus is never replaced.
+static TickType_t send_urgent_frame(const struct dali_tx_frame frame)
+{
+    const TickType_t start = xTaskGetTickCount();
+    serial.urgent = true;
+    while (true) {
+        vTaskSuspendAll();
+        const bool expired = (xTaskGetTickCount() - start) >= pdMS_TO_TICKS(SERIAL_URGENT_WAIT_MS);
+        if (dali_101_tx_is_idle() || (expired && !dali_101_tx_is_sending())) {
+            echo_expect(&frame);
+            dali_101_send(frame);
+            serial.urgent = false;
+            xTaskResumeAll();
+            return xTaskGetTickCount() - start;
+        }
+        xTaskResumeAll();
+        vTaskDelay(1);
+    }
+}
+
+bool serial_urgent_is_pending(void)
+{
+    return serial.urgent;
+}
+
+static void urgent_command(char* argument_buffer)
 {
     char* end_of_read;
-    const uint8_t priority = strtoul(argument_buffer, &end_of_read, 16);
-    const uint8_t length = strtoul(end_of_read, &end_of_read, 16);
-    const char twice_indicator = *end_of_read++;
+    const uint8_t length = strtoul(argument_buffer, &end_of_read, 16);
+    const char twice_indicator = *end_of_read;
+    if (twice_indicator) {
+        end_of_read++;
+    }
     const uint64_t data = strtoull(end_of_read, &end_of_read, 16);
-
-    if (priority_or_length_illegal(priority, length) || data_illegal(data, length)) {
+    if (!length || priority_or_length_illegal(1, length) || data_illegal(data, length)) {
         print_parameter_error();
         return;
     }
-    const struct dali_tx_frame frame = { .type = get_forward_type(priority),
+    const struct dali_tx_frame frame = { .type = DALI_FRAME_FORWARD_1,
                                          .repeat = (twice_indicator == SERIAL_CHAR_TWICE) ? 1 : 0,
                                          .length = length,
                                          .data = data };
-    queue_frame(frame);
+    const uint8_t requests = flush_queue();
+    const uint8_t repeats = dali_101_cancel_repeat();
+    const uint32_t wait_ms = pdTICKS_TO_MS(send_urgent_frame(frame));
+    const uint8_t result[SERIAL_URGENT_REPORT_SIZE] = { requests, repeats, wait_ms >> 8U, wait_ms };
+    serial_print_block(SERIAL_REPORT_URGENT, result, sizeof(result));
 }
 
-static void send_backframe_command(char* argument_buffer)
+static void time_command(char* argument_buffer)
 {
     char* end_of_read;
-    const uint64_t data = strtoull(argument_buffer, &end_of_read, 16);
+    const char action = *argument_buffer;
+    switch (action) {
+    case SERIAL_CHAR_TIME_READ: {
+        if (*skip_blanks(argument_buffer + 1) != '\000') {
+            print_parameter_error();
+            return;
+        }
+        uint8_t result[SERIAL_TIME_REPORT_SIZE];
+        serial_put_uint32(result, dali_101_get_time());
+        serial_print_block(SERIAL_REPORT_DEVICE_TIME, result, sizeof(result));
+        return;
+    }
+    case SERIAL_CHAR_TIME_SEND:
+    case SERIAL_CHAR_TIME_QUERY: {
+        struct serial_request request = { .job = SERIAL_JOB_TIMED_FRAME };
+        request.timed_frame.time_us = strtoul(argument_buffer + 1, &end_of_read, 16);
+        if (!parse_frame(end_of_read, &end_of_read, (action == SERIAL_CHAR_TIME_QUERY), &request.timed_frame.frame)) {
+            print_parameter_error();
+            return;
+        }
+        queue_request(request);
+        return;
+    }
+    case SERIAL_CHAR_TIME_SYNC: {
+        const uint32_t host_time = strtoul(argument_buffer + 1, &end_of_read, 16);
+        if (end_of_read == argument_buffer + 1 || *skip_blanks(end_of_read) != '\000') {
+            print_parameter_error();
+            return;
+        }
+        uint8_t result[SERIAL_SYNC_REPORT_SIZE];
+        serial_put_uint32(&result[0], host_time);
+        serial_put_uint32(&result[4], serial.receive_time);
+        serial_put_uint32(&result[8], dali_101_get_time());
+        serial_print_block(SERIAL_REPORT_TIME_SYNC, result, sizeof(result));
+        return;
+    }
+    case SERIAL_CHAR_TIME_ALIGN: {
+        const uint32_t device_us = strtoul(argument_buffer + 1, &end_of_read, 16);
+        const uint32_t host_us = strtoul(end_of_read, &end_of_read, 16);
+        const int32_t drift_ppb = strtol(end_of_read, &end_of_read, 16);
+        if (drift_ppb > SERIAL_MAX_DRIFT_PPB || drift_ppb < -SERIAL_MAX_DRIFT_PPB ||
+            *skip_blanks(end_of_read) != '\000') {
+            print_parameter_error();
+            return;
+        }
+        taskENTER_CRITICAL();
+        serial.align_device_us = device_us;
+        serial.align_host_us = host_us;
+        serial.align_drift_ppb = drift_ppb;
+        taskEXIT_CRITICAL();
+        return;
+    }
+    default:
+        print_parameter_error();
+    }
+}
 
-    if (data > 0xFF) {
+static bool parse_trigger(char* argument_buffer, char** end_of_read, struct dali_trigger* trigger)
+{
+    const uint32_t delay_us = strtoul(argument_buffer, end_of_read, 16);
+    const uint8_t prefix_length = strtoul(*end_of_read, end_of_read, 16);
+    const uint64_t prefix = strtoull(*end_of_read, end_of_read, 16);
+    if (prefix_length > DALI_MAX_DATA_LENGTH || prefix >= ((uint64_t)1 << prefix_length)) {
+        return false;
+    }
+    *trigger = (struct dali_trigger){ .delay_us = delay_us, .prefix = prefix, .prefix_length = prefix_length };
+    return true;
+}
+
+static void trigger_command(char* argument_buffer)
+{
+    char* end_of_read;
+    const char kind = *argument_buffer;
+    struct serial_request request = { .job = SERIAL_JOB_TRIGGERED_FRAME };
+    if (!parse_trigger(argument_buffer + 1, &end_of_read, &request.triggered_frame.trigger)) {
+        print_parameter_error();
+        return;
+    }
+    bool valid = false;
+    switch (kind) {
+    case SERIAL_CHAR_TRIGGER_SEND:
+        valid = parse_frame(end_of_read, &end_of_read, false, &request.triggered_frame.frame);
+        break;
+    case SERIAL_CHAR_TRIGGER_BACKFRAME:
+        valid = parse_backframe(end_of_read, &end_of_read, &request.triggered_frame.frame);
+        break;
+    case SERIAL_CHAR_TRIGGER_SEQUENCE:
+        request.triggered_frame.frame = (struct dali_tx_frame){
+            .type = get_forward_type(SERIAL_SEQUENCE_DEFAULT_PRIORITY), .sequence = true
+        };
+        valid = true;
+        break;
+    }
+    if (!valid || *skip_blanks(end_of_read) != '\000') {
+        print_parameter_error();
+        return;
+    }
+    queue_request(request);
+}
+
+static void calibrate_command(char* argument_buffer)
+{
+    char* end_of_read;
+    const char action = *argument_buffer;
+    if (action == SERIAL_CHAR_CALIBRATE_RX) {
+        const uint32_t frames = strtoul(argument_buffer + 1, &end_of_read, 16);
+        if (frames == 0 || frames > UINT8_MAX || *skip_blanks(end_of_read) != '\000') {
+            print_parameter_error();
+            return;
+        }
+        const struct serial_request request = { .job = SERIAL_JOB_CALIBRATE, .calibrate = { .frames = frames } };
+        queue_request(request);
+        return;
+    }
+    if (action == SERIAL_CHAR_CALIBRATE_TX) {
+        const uint32_t mode = strtoul(argument_buffer + 1, &end_of_read, 16);
+        if (mode >= CALIBRATE_TX_MODES || end_of_read == argument_buffer + 1 || *skip_blanks(end_of_read) != '\000') {
+            print_parameter_error();
+            return;
+        }
+        calibrate_tx_configure((enum calibrate_tx_mode)mode);
+        return;
+    }
+    if (action == SERIAL_CHAR_CALIBRATE_STATISTICS) {
+        const uint32_t reset = strtoul(argument_buffer + 1, &end_of_read, 16);
+        if (reset > 1 || *skip_blanks(end_of_read) != '\000') {
+            print_parameter_error();
+            return;
+        }
+        calibrate_tx_report(reset);
+        return;
+    }
+    if (*skip_blanks(argument_buffer + 1) != '\000') {
+        print_parameter_error();
+        return;
+    }
+    switch (action) {
+    case SERIAL_CHAR_CALIBRATE_FOREIGN:
+        calibrate_measure_foreign();
+        return;
+    case SERIAL_CHAR_CALIBRATE_APPLY:
+        calibrate_apply();
+        return;
+    case SERIAL_CHAR_CALIBRATE_SAVE: {
+        const struct serial_request request = { .job = SERIAL_JOB_SAVE_SETTINGS };
+        queue_request(request);
+        return;
+    }
+    case SERIAL_CHAR_CALIBRATE_DEFAULTS:
+        settings_defaults();
+        return;
+    default:
+        print_parameter_error();
+    }
+}
+
+static void report_settling(void)
+{
+    struct dali_settling_times times;
+    dali_101_get_settling_times(&times);
+    uint8_t result[(DALI_PRIORITIES + 3) * sizeof(uint32_t)];
+    serial_put_uint32(&result[0], times.backward_us);
+    for (uint_fast8_t i = 0; i < DALI_PRIORITIES; i++) {
+        serial_put_uint32(&result[(i + 1) * sizeof(uint32_t)], times.forward_us[i]);
+    }
+    serial_put_uint32(&result[(DALI_PRIORITIES + 1) * sizeof(uint32_t)], times.back_to_back_us);
+    serial_put_uint32(&result[(DALI_PRIORITIES + 2) * sizeof(uint32_t)], times.min_slack_us);
+    serial_print_block(SERIAL_REPORT_SETTLING, result, sizeof(result));
+}
+
+static void report_start(bool reset)
+{
+    struct dali_start_statistics statistics;
+    dali_101_get_start_statistics(&statistics, reset);
+    const int32_t mean = statistics.count ? (statistics.delay_sum_us * 10) / (int32_t)statistics.count : 0;
+    uint8_t result[16];
+    serial_put_uint32(&result[0], statistics.count);
+    serial_put_uint32(&result[4], mean);
+    serial_put_uint32(&result[8], statistics.delay_min_us);
+    serial_put_uint32(&result[12], statistics.delay_max_us);
+    serial_print_block(SERIAL_REPORT_START_TIMING, result, sizeof(result));
+}
+
+static void settling_command(char* argument_buffer)
+{
+    char* end_of_read;
+    const char action = *argument_buffer;
+    switch (action) {
+    case SERIAL_CHAR_SETTLING_PROFILE: {
+        const uint32_t profile = strtoul(argument_buffer + 1, &end_of_read, 16);
+        if (end_of_read == argument_buffer + 1 || profile >= DALI_SETTLING_PROFILES ||
+            *skip_blanks(end_of_read) != '\000') {
+            print_parameter_error();
+            return;
+        }
+        dali_101_set_settling_profile((enum dali_settling_profile)profile);
+        return;
+    }
+    case SERIAL_CHAR_SETTLING_TIMES: {
+        struct dali_settling_times times;
+        uint32_t* value[] = { &times.backward_us,     &times.forward_us[0], &times.forward_us[1],
+                              &times.forward_us[2],   &times.forward_us[3], &times.forward_us[4],
+                              &times.back_to_back_us, &times.min_slack_us };
+        end_of_read = argument_buffer + 1;
+        for (uint_fast8_t i = 0; i < (sizeof(value) / sizeof(value[0])); i++) {
+            char* start = skip_blanks(end_of_read);
+            *value[i] = strtoul(start, &end_of_read, 16);
+            if (end_of_read == start) {
+                print_parameter_error();
+                return;
+            }
+        }
+        if (*skip_blanks(end_of_read) != '\000' || !dali_101_set_settling_times(&times)) {
+            print_parameter_error();
+        }
+        return;
+    }
+    case SERIAL_CHAR_SETTLING_REPORT:
+        if (*skip_blanks(argument_buffer + 1) != '\000') {
+            print_parameter_error();
+            return;
+        }
+        report_settling();
+        return;
+    case SERIAL_CHAR_SETTLING_START: {
+        const uint32_t reset = strtoul(argument_buffer + 1, &end_of_read, 16);
+        if (reset > 1 || *skip_blanks(end_of_read) != '\000') {
+            print_parameter_error();
+            return;
+        }
+        report_start(reset);
+        return;
+    }
+    default:
+        print_parameter_error();
+    }
+}
+
+static void send_backframe_command(char* argument_buffer)
+{
+    char* end_of_read;
+    struct dali_tx_frame frame;
+    if (!parse_backframe(argument_buffer, &end_of_read, &frame)) {
         print_parameter_error();
         return;
     }
-    const struct dali_tx_frame frame = { .type = DALI_FRAME_BACKWARD, .repeat = 0, .length = 8, .data = data };
     queue_frame(frame);
 }
 
@@ -215,17 +819,11 @@ static void send_corrupt_frame_command(void)
 static void send_repeated_command(char* argument_buffer)
 {
     char* end_of_read;
-    const uint8_t priority = strtoul(argument_buffer, &end_of_read, 16);
-    const uint8_t repeat = strtoul(end_of_read, &end_of_read, 16);
-    const uint8_t length = strtoul(end_of_read, &end_of_read, 16);
-    const uint64_t data = strtoull(end_of_read, &end_of_read, 16);
-    if (priority_or_length_illegal(priority, length) || data_illegal(data, length)) {
+    struct dali_tx_frame frame;
+    if (!parse_repeated_frame(argument_buffer, &end_of_read, &frame)) {
         print_parameter_error();
         return;
     }
-    const struct dali_tx_frame frame = {
-        .type = get_forward_type(priority), .repeat = repeat, .length = length, .data = data
-    };
     queue_frame(frame);
 }
 
@@ -233,7 +831,7 @@ static void next_sequence(char* argument_buffer)
 {
     char* end_of_read;
     const uint32_t period_us = strtoul(argument_buffer, &end_of_read, 16);
-    if (period_us == 0) {
+    if (period_us == 0 || serial.sequences) {
         print_parameter_error();
         return;
     }
@@ -244,7 +842,7 @@ static void start_sequence(char* argument_buffer)
 {
     char* end_of_read;
     const uint32_t period_us = strtoul(argument_buffer, &end_of_read, 16);
-    if (period_us == 0) {
+    if (period_us == 0 || serial.sequences) {
         print_parameter_error();
         return;
     }
@@ -252,6 +850,550 @@ static void start_sequence(char* argument_buffer)
     dali_101_sequence_next(period_us);
 }
 
+static void execute_sequence(char* argument_buffer)
+{
+    char* end_of_read;
+    uint8_t priority = strtoul(argument_buffer, &end_of_read, 16);
+    if (end_of_read == argument_buffer) {
+        priority = SERIAL_SEQUENCE_DEFAULT_PRIORITY;
+    }
+    if (priority_or_length_illegal(priority, 0)) {
+        print_parameter_error();
+        return;
+    }
+    const struct dali_tx_frame frame = { .type = get_forward_type(priority), .sequence = true };
+    queue_frame(frame);
+}
+
+static uint64_t get_scan_addresses(char* argument_buffer, char** end_of_read)
+{
+    const uint64_t first = strtoull(argument_buffer, end_of_read, 16);
+    if (**end_of_read != SERIAL_CHAR_RANGE) {
+        return first;
+    }
+    const uint64_t last = strtoull(*end_of_read + 1, end_of_read, 16);
+    if (first > last || last > 63) {
+        return 0;
+    }
+    const uint64_t upper = (last == 63) ? UINT64_MAX : (((uint64_t)1 << (last + 1)) - 1);
+    return upper & ~(((uint64_t)1 << first) - 1);
+}
+
+static void scan_command(char* argument_buffer)
+{
+    char* end_of_read;
+    const uint8_t priority = strtoul(argument_buffer, &end_of_read, 16);
+    struct serial_request request = { .job = SERIAL_JOB_SCAN };
+    request.scan.type = get_query_type(priority);
+    request.scan.addresses = get_scan_addresses(end_of_read, &end_of_read);
+    while (*end_of_read != '\000') {
+        char* start_of_read = end_of_read;
+        const uint32_t opcode = strtoul(start_of_read, &end_of_read, 16);
+        if (end_of_read == start_of_read) {
+            break;
+        }
+        if (opcode > 0xFF || request.scan.opcode_count >= SCAN_MAX_OPCODES) {
+            print_parameter_error();
+            return;
+        }
+        request.scan.opcode[request.scan.opcode_count++] = opcode;
+    }
+    if (request.scan.type == DALI_FRAME_NONE || request.scan.addresses == 0 || request.scan.opcode_count == 0) {
+        print_parameter_error();
+        return;
+    }
+    queue_request(request);
+}
+
+static void commission_command(char* argument_buffer)
+{
+    char* end_of_read;
+    const uint8_t priority = strtoul(argument_buffer, &end_of_read, 16);
+    const uint32_t first_address = strtoul(end_of_read, &end_of_read, 16);
+    const uint32_t mode = strtoul(end_of_read, &end_of_read, 16);
+    const enum dali_frame_type query_type = get_query_type(priority);
+    if (query_type == DALI_FRAME_NONE || first_address > 63 || mode > 1) {
+        print_parameter_error();
+        return;
+    }
+    const struct serial_request request = { .job = SERIAL_JOB_COMMISSION,
+                                            .commission = { .forward_type = get_forward_type(priority),
+                                                            .query_type = query_type,
+                                                            .first_address = first_address,
+                                                            .unaddressed_only = (mode == 1) } };
+    queue_request(request);
+}
+
+static uint_fast8_t get_hex_bytes(const char* argument_buffer, uint8_t* data, uint_fast8_t max_length)
+{
+    while (*argument_buffer == ' ') {
+        argument_buffer++;
+    }
+    uint_fast8_t length = 0;
+    while (isxdigit((unsigned char)argument_buffer[0]) && isxdigit((unsigned char)argument_buffer[1])) {
+        if (length >= max_length) {
+            return 0;
+        }
+        const char digits[] = { argument_buffer[0], argument_buffer[1], '\000' };
+        data[length++] = strtoul(digits, NULL, 16);
+        argument_buffer += 2;
+    }
+    if (*argument_buffer) {
+        return 0;
+    }
+    return length;
+}
+
+static void memory_bank_command(char* argument_buffer)
+{
+    const char operation = *argument_buffer;
+    if (operation != SERIAL_CHAR_READ && operation != SERIAL_CHAR_WRITE) {
+        print_parameter_error();
+        return;
+    }
+    char* end_of_read;
+    const uint8_t priority = strtoul(argument_buffer + 1, &end_of_read, 16);
+    const uint32_t address = strtoul(end_of_read, &end_of_read, 16);
+    const uint32_t bank = strtoul(end_of_read, &end_of_read, 16);
+    const uint32_t location = strtoul(end_of_read, &end_of_read, 16);
+    struct serial_request request = { .job = SERIAL_JOB_MEMORY_BANK };
+    request.memory_bank.forward_type = get_forward_type(priority);
+    request.memory_bank.query_type = get_query_type(priority);
+    request.memory_bank.address = address;
+    request.memory_bank.bank = bank;
+    request.memory_bank.location = location;
+    if (operation == SERIAL_CHAR_WRITE) {
+        request.memory_bank.write = true;
+        request.memory_bank.count = get_hex_bytes(end_of_read, request.memory_bank.data, MEMORY_BANK_MAX_WRITE);
+    } else {
+        const uint32_t count = strtoul(end_of_read, &end_of_read, 16);
+        request.memory_bank.count = (count > MEMORY_BANK_MAX_READ) ? 0 : count;
+    }
+    if (request.memory_bank.query_type == DALI_FRAME_NONE || address > 63 || bank > 0xFF || location > 0xFF ||
+        request.memory_bank.count == 0 || location + request.memory_bank.count > MEMORY_BANK_LOCATIONS) {
+        print_parameter_error();
+        return;
+    }
+    queue_request(request);
+}
+
+static void add_job(char* argument_buffer, bool query)
+{
+    char* end_of_read;
+    const uint32_t id = strtoul(argument_buffer, &end_of_read, 16);
+    const uint8_t priority = strtoul(end_of_read, &end_of_read, 16);
+    const uint32_t period_ms = strtoul(end_of_read, &end_of_read, 16);
+    const uint32_t jitter_ms = strtoul(end_of_read, &end_of_read, 16);
+    const uint8_t length = strtoul(end_of_read, &end_of_read, 16);
+    const uint64_t data = strtoull(end_of_read, &end_of_read, 16);
+    if (priority_or_length_illegal(priority, length) || data_illegal(data, length) || id > UINT8_MAX ||
+        jitter_ms > UINT16_MAX) {
+        print_parameter_error();
+        return;
+    }
+    const struct dali_tx_frame frame = { .type = query ? get_query_type(priority) : get_forward_type(priority),
+                                         .length = length,
+                                         .data = data };
+    if (!schedule_add(id, frame, period_ms, jitter_ms)) {
+        print_parameter_error();
+    }
+}
+
+static void job_command(char* argument_buffer)
+{
+    switch (*argument_buffer) {
+    case SERIAL_CHAR_JOB_SEND:
+        add_job(argument_buffer + 1, false);
+        return;
+    case SERIAL_CHAR_JOB_QUERY:
+        add_job(argument_buffer + 1, true);
+        return;
+    case SERIAL_CHAR_JOB_DELETE:
+        if (!schedule_remove(strtoul(argument_buffer + 1, NULL, 16))) {
+            print_parameter_error();
+        }
+        return;
+    case SERIAL_CHAR_JOB_LIST:
+        schedule_list();
+        return;
+    default:
+        print_parameter_error();
+    }
+}
+
+static bool parse_macro_step(char* argument_buffer, struct macro_step* step)
+{
+    char* end_of_read;
+    bool valid = false;
+    const char kind = *argument_buffer++;
+    switch (kind) {
+    case SERIAL_CHAR_STEP_SEND:
+        valid = parse_frame(argument_buffer, &end_of_read, false, &step->frame);
+        break;
+    case SERIAL_CHAR_STEP_QUERY:
+        valid = parse_frame(argument_buffer, &end_of_read, true, &step->frame);
+        break;
+    case SERIAL_CHAR_STEP_REPEAT:
+        valid = parse_repeated_frame(argument_buffer, &end_of_read, &step->frame);
+        break;
+    case SERIAL_CHAR_STEP_BACKFRAME:
+        valid = parse_backframe(argument_buffer, &end_of_read, &step->frame);
+        break;
+    }
+    if (!valid || step->frame.type == DALI_FRAME_NONE) {
+        return false;
+    }
+    end_of_read = skip_blanks(end_of_read);
+    step->parameter_shift = MACRO_NO_PARAMETER;
+    if (*end_of_read == SERIAL_CHAR_PARAMETER) {
+        const uint32_t shift = strtoul(end_of_read + 1, &end_of_read, 16);
+        if (shift >= DALI_MAX_DATA_LENGTH) {
+            return false;
+        }
+        step->parameter_shift = shift;
+        end_of_read = skip_blanks(end_of_read);
+    }
+    if (*end_of_read == SERIAL_CHAR_EXPECT) {
+        const uint32_t value = strtoul(end_of_read + 1, &end_of_read, 16);
+        const uint32_t mask = strtoul(end_of_read, &end_of_read, 16);
+        if (kind != SERIAL_CHAR_STEP_QUERY || value > 0xFF || mask > 0xFF) {
+            return false;
+        }
+        step->check_reply = true;
+        step->expected_value = value;
+        step->expected_mask = mask;
+        end_of_read = skip_blanks(end_of_read);
+    }
+    return (*end_of_read == '\000');
+}
+
+static void macro_command(char* argument_buffer)
+{
+    char* end_of_read;
+    const char operation = *argument_buffer;
+    const uint32_t id = strtoul(argument_buffer + 1, &end_of_read, 16);
+    if (operation == '\000' || id >= MACRO_MAX_MACROS) {
+        print_parameter_error();
+        return;
+    }
+    switch (operation) {
+    case SERIAL_CHAR_MACRO_CLEAR:
+        macro_clear(id);
+        return;
+    case SERIAL_CHAR_MACRO_ADD: {
+        struct macro_step step = { 0 };
+        if (!parse_macro_step(skip_blanks(end_of_read), &step) || !macro_append(id, step)) {
+            print_parameter_error();
+        }
+        return;
+    }
+    case SERIAL_CHAR_MACRO_EXECUTE: {
+        const struct serial_request request = {
+            .job = SERIAL_JOB_MACRO,
+            .macro = { .id = id, .parameter = strtoul(end_of_read, &end_of_read, 16) },
+        };
+        if (!macro_parameter_fits(id, request.macro.parameter)) {
+            print_parameter_error();
+            return;
+        }
+        queue_request(request);
+        return;
+    }
+    default:
+        print_parameter_error();
+    }
+}
+
+static bool parse_condition_frame(char* argument_buffer, char** end_of_read, struct condition_frame* frame)
+{
+    const uint8_t length = strtoul(argument_buffer, end_of_read, 16);
+    const char twice_indicator = **end_of_read;
+    if (twice_indicator) {
+        (*end_of_read)++;
+    }
+    const uint64_t data = strtoull(*end_of_read, end_of_read, 16);
+    if (length > DALI_MAX_DATA_LENGTH || data_illegal(data, length)) {
+        return false;
+    }
+    *frame = (struct condition_frame){ .data = data, .length = length, .twice = (twice_indicator == SERIAL_CHAR_TWICE) };
+    return true;
+}
+
+static void condition_command(char* argument_buffer)
+{
+    char* end_of_read;
+    const uint8_t priority = strtoul(argument_buffer, &end_of_read, 16);
+    const uint8_t length = strtoul(end_of_read, &end_of_read, 16);
+    const uint64_t data = strtoull(end_of_read, &end_of_read, 16);
+    end_of_read = skip_blanks(end_of_read);
+    if (priority_or_length_illegal(priority, length) || data_illegal(data, length) ||
+        get_query_type(priority) == DALI_FRAME_NONE || *end_of_read != SERIAL_CHAR_EXPECT) {
+        print_parameter_error();
+        return;
+    }
+    const uint32_t value = strtoul(end_of_read + 1, &end_of_read, 16);
+    const uint32_t mask = strtoul(end_of_read, &end_of_read, 16);
+    struct serial_request request = {
+        .job = SERIAL_JOB_CONDITION,
+        .condition = { .query_type = get_query_type(priority),
+                       .forward_type = get_forward_type(priority),
+                       .query_data = data,
+                       .query_length = length,
+                       .value = value,
+                       .mask = mask },
+    };
+    bool valid = (value <= 0xFF && mask <= 0xFF);
+    for (size_t i = 0; valid && i < CONDITION_BRANCHES; i++) {
+        end_of_read = skip_blanks(end_of_read);
+        if (*end_of_read != '\000') {
+            valid = parse_condition_frame(end_of_read, &end_of_read, &request.condition.frame[i]);
+        }
+    }
+    if (!valid || *skip_blanks(end_of_read) != '\000') {
+        print_parameter_error();
+        return;
+    }
+    queue_request(request);
+}
+
+static bool parse_responder_entry(char* argument_buffer, struct responder_entry* entry)
+{
+    char* end_of_read;
+    const uint8_t length = strtoul(argument_buffer, &end_of_read, 16);
+    const uint64_t value = strtoull(end_of_read, &end_of_read, 16);
+    const uint64_t mask = strtoull(end_of_read, &end_of_read, 16);
+    const uint32_t backframe = strtoul(end_of_read, &end_of_read, 16);
+    const uint32_t delay_us = strtoul(end_of_read, &end_of_read, 16);
+    if (length == 0 || length > DALI_MAX_DATA_LENGTH || data_illegal(value, length) || data_illegal(mask, length) ||
+        backframe > 0xFF || delay_us > RESPONDER_MAX_DELAY_US || *skip_blanks(end_of_read) != '\000') {
+        return false;
+    }
+    *entry = (struct responder_entry){
+        .value = value, .mask = mask, .length = length, .backframe = backframe, .delay_us = delay_us
+    };
+    return true;
+}
+
+static void responder_command(char* argument_buffer)
+{
+    switch (*argument_buffer) {
+    case SERIAL_CHAR_RESPONDER_CLEAR:
+        responder_clear();
+        return;
+    case SERIAL_CHAR_RESPONDER_ADD: {
+        struct responder_entry entry;
+        if (!parse_responder_entry(argument_buffer + 1, &entry) || !responder_add(entry)) {
+            print_parameter_error();
+        }
+        return;
+    }
+    default:
+        print_parameter_error();
+    }
+}
+
+static void gear_command(char* argument_buffer)
+{
+    char* end_of_read;
+    const char operation = *argument_buffer;
+    if (operation == SERIAL_CHAR_GEAR_CLEAR) {
+        gear_clear();
+        return;
+    }
+    const uint32_t value = strtoul(argument_buffer + 1, &end_of_read, 16);
+    if (operation == '\000' || value > 0xFF || *skip_blanks(end_of_read) != '\000') {
+        print_parameter_error();
+        return;
+    }
+    switch (operation) {
+    case SERIAL_CHAR_GEAR_ADD:
+        if (!gear_add(value)) {
+            print_parameter_error();
+        }
+        return;
+    case SERIAL_CHAR_GEAR_REPORT:
+        if (!gear_report(value)) {
+            print_parameter_error();
+        }
+        return;
+    default:
+        print_parameter_error();
+    }
+}
+
+static bool parse_filter_rule(char* argument_buffer, enum filter_action action, struct filter_rule* rule)
+{
+    char* end_of_read;
+    const uint32_t source = strtoul(argument_buffer, &end_of_read, 16);
+    const uint32_t class = strtoul(end_of_read, &end_of_read, 16);
+    const uint8_t length = strtoul(end_of_read, &end_of_read, 16);
+    const uint64_t value = strtoull(end_of_read, &end_of_read, 16);
+    const uint64_t mask = strtoull(end_of_read, &end_of_read, 16);
+    if (source >= FILTER_SOURCES || class >= FILTER_CLASSES || length > DALI_MAX_DATA_LENGTH || value > UINT32_MAX ||
+        mask > UINT32_MAX || *skip_blanks(end_of_read) != '\000') {
+        return false;
+    }
+    *rule = (struct filter_rule){
+        .action = action, .source = source, .class = class, .length = length, .value = value, .mask = mask
+    };
+    return true;
+}
+
+static void filter_command(char* argument_buffer)
+{
+    const char operation = *argument_buffer;
+    switch (operation) {
+    case SERIAL_CHAR_FILTER_CLEAR:
+        filter_clear();
+        return;
+    case SERIAL_CHAR_FILTER_REPORT:
+        filter_report();
+        return;
+    case SERIAL_CHAR_FILTER_INCLUDE:
+    case SERIAL_CHAR_FILTER_EXCLUDE: {
+        const enum filter_action action = (operation == SERIAL_CHAR_FILTER_INCLUDE) ? FILTER_INCLUDE : FILTER_EXCLUDE;
+        struct filter_rule rule;
+        if (!parse_filter_rule(argument_buffer + 1, action, &rule) || !filter_add(rule)) {
+            print_parameter_error();
+        }
+        return;
+    }
+    default:
+        print_parameter_error();
+    }
+}
+
+static void capture_command(char* argument_buffer)
+{
+    char* end_of_read;
+    const char operation = *argument_buffer;
+    if (operation == SERIAL_CHAR_CAPTURE_STATUS || operation == SERIAL_CHAR_CAPTURE_MATCH) {
+        struct capture_trigger trigger = { 0 };
+        const uint32_t post = strtoul(argument_buffer + 1, &end_of_read, 16);
+        bool valid = (end_of_read != argument_buffer + 1 && post <= CAPTURE_MAX_POST_EDGES);
+        if (operation == SERIAL_CHAR_CAPTURE_STATUS) {
+            char* status_start = skip_blanks(end_of_read);
+            const uint32_t status = strtoul(status_start, &end_of_read, 16);
+            valid = valid && end_of_read != status_start && status && status <= UINT8_MAX &&
+                    *skip_blanks(end_of_read) == '\000';
+            trigger.status = status;
+        } else {
+            valid = valid && parse_filter_rule(end_of_read, FILTER_INCLUDE, &trigger.rule);
+        }
+        if (!valid) {
+            print_parameter_error();
+            return;
+        }
+        trigger.post = post;
+        capture_arm(&trigger);
+        return;
+    }
+    const uint32_t value = strtoul(argument_buffer, &end_of_read, 16);
+    if (end_of_read == argument_buffer || value > 1 || *skip_blanks(end_of_read) != '\000') {
+        print_parameter_error();
+        return;
+    }
+    if (value) {
+        capture_start();
+    } else {
+        capture_stop();
+    }
+}
+
+static void option_command(char* argument_buffer)
+{
+    char* end_of_read;
+    const char option = *argument_buffer;
+    const uint32_t value = strtoul(argument_buffer + 1, &end_of_read, 16);
+    switch (option) {
+    case SERIAL_CHAR_OPTION_ECHO: {
+        uint32_t period_ms = ECHO_DEFAULT_PERIOD_MS;
+        end_of_read = skip_blanks(end_of_read);
+        if (*end_of_read != '\000') {
+            period_ms = strtoul(end_of_read, &end_of_read, 16);
+        }
+        if (value > 1 || *skip_blanks(end_of_read) != '\000') {
+            print_parameter_error();
+            return;
+        }
+        echo_configure(value, period_ms);
+        return;
+    }
+    case SERIAL_CHAR_OPTION_MERGE:
+        if (value > 1 || *skip_blanks(end_of_read) != '\000') {
+            print_parameter_error();
+            return;
+        }
+        serial.merge = value;
+        serial.queued = 0;
+        serial.merged = 0;
+        return;
+    case SERIAL_CHAR_OPTION_TIMESTAMP:
+        if (value >= SERIAL_TIMESTAMPS || *skip_blanks(end_of_read) != '\000') {
+            print_parameter_error();
+            return;
+        }
+        serial.timestamp = value;
+        return;
+    case SERIAL_CHAR_OPTION_CACHE: {
+        end_of_read = skip_blanks(argument_buffer + 1);
+        if (*end_of_read == '\000') {
+            cache_clear();
+            return;
+        }
+        const uint32_t max_age_ms = strtoul(end_of_read, &end_of_read, 16);
+        if (value > 0xFF || *skip_blanks(end_of_read) != '\000' || !cache_set_age(value, max_age_ms)) {
+            print_parameter_error();
+        }
+        return;
+    }
+    default:
+        print_parameter_error();
+    }
+}
+
+static void statistics_command(char* argument_buffer)
+{
+    char* end_of_read;
+    const char statistics = *argument_buffer;
+    switch (statistics) {
+    case SERIAL_CHAR_STATISTICS_UTILISATION: {
+        const uint32_t window_ms = strtoul(argument_buffer + 1, &end_of_read, 16);
+        if (*skip_blanks(end_of_read) != '\000' || !meter_configure(window_ms)) {
+            print_parameter_error();
+        }
+        return;
+    }
+    case SERIAL_CHAR_STATISTICS_ADDRESSES: {
+        const uint32_t reset = strtoul(argument_buffer + 1, &end_of_read, 16);
+        if (reset > 1 || *skip_blanks(end_of_read) != '\000') {
+            print_parameter_error();
+            return;
+        }
+        traffic_report(reset);
+        return;
+    }
+    case SERIAL_CHAR_STATISTICS_MERGE: {
+        const uint32_t reset = strtoul(argument_buffer + 1, &end_of_read, 16);
+        if (reset > 1 || *skip_blanks(end_of_read) != '\000') {
+            print_parameter_error();
+            return;
+        }
+        print_merge_report(reset);
+        return;
+    }
+    case SERIAL_CHAR_STATISTICS_STACK:
+        if (*skip_blanks(argument_buffer + 1) != '\000') {
+            print_parameter_error();
+            return;
+        }
+        print_stack_report();
+        return;
+    default:
+        print_parameter_error();
+    }
+}
+
 __attribute__((noreturn)) static void serial_task(__attribute__((unused)) void* dummy)
 {
     while (true) {
@@ -293,7 +1435,75 @@ __attribute__((noreturn)) static void serial_task(__attribute__((unused)) void*
                 break;
             case SERIAL_CMD_EXECUTE_SEQ:
                 board_flash(LED_SERIAL);
-                dali_101_sequence_execute();
+                execute_sequence(&serial.cmd_buffer[SERIAL_IDX_ARG]);
+                break;
+            case SERIAL_CMD_SCAN:
+                board_flash(LED_SERIAL);
+                scan_command(&serial.cmd_buffer[SERIAL_IDX_ARG]);
+                break;
+            case SERIAL_CMD_COMMISSION:
+                board_flash(LED_SERIAL);
+                commission_command(&serial.cmd_buffer[SERIAL_IDX_ARG]);
+                break;
+            case SERIAL_CMD_MEMORY_BANK:
+                board_flash(LED_SERIAL);
+                memory_bank_command(&serial.cmd_buffer[SERIAL_IDX_ARG]);
+                break;
+            case SERIAL_CMD_JOB:
+                board_flash(LED_SERIAL);
+                job_command(&serial.cmd_buffer[SERIAL_IDX_ARG]);
+                break;
+            case SERIAL_CMD_MACRO:
+                board_flash(LED_SERIAL);
+                macro_command(&serial.cmd_buffer[SERIAL_IDX_ARG]);
+                break;
+            case SERIAL_CMD_CONDITION:
+                board_flash(LED_SERIAL);
+                condition_command(&serial.cmd_buffer[SERIAL_IDX_ARG]);
+                break;
+            case SERIAL_CMD_RESPONDER:
+                board_flash(LED_SERIAL);
+                responder_command(&serial.cmd_buffer[SERIAL_IDX_ARG]);
+                break;
+            case SERIAL_CMD_GEAR:
+                board_flash(LED_SERIAL);
+                gear_command(&serial.cmd_buffer[SERIAL_IDX_ARG]);
+                break;
+            case SERIAL_CMD_FILTER:
+                board_flash(LED_SERIAL);
+                filter_command(&serial.cmd_buffer[SERIAL_IDX_ARG]);
+                break;
+            case SERIAL_CMD_OPTION:
+                board_flash(LED_SERIAL);
+                option_command(&serial.cmd_buffer[SERIAL_IDX_ARG]);
+                break;
+            case SERIAL_CMD_STATISTICS:
+                board_flash(LED_SERIAL);
+                statistics_command(&serial.cmd_buffer[SERIAL_IDX_ARG]);
+                break;
+            case SERIAL_CMD_URGENT:
+                board_flash(LED_SERIAL);
+                urgent_command(&serial.cmd_buffer[SERIAL_IDX_ARG]);
+                break;
+            case SERIAL_CMD_TIME:
+                board_flash(LED_SERIAL);
+                time_command(&serial.cmd_buffer[SERIAL_IDX_ARG]);
+                break;
+            case SERIAL_CMD_TRIGGER:
+                board_flash(LED_SERIAL);
+                trigger_command(&serial.cmd_buffer[SERIAL_IDX_ARG]);
+                break;
+            case SERIAL_CMD_CAPTURE:
+                board_flash(LED_SERIAL);
+                capture_command(&serial.cmd_buffer[SERIAL_IDX_ARG]);
+                break;
+            case SERIAL_CMD_CALIBRATE:
+                board_flash(LED_SERIAL);
+                calibrate_command(&serial.cmd_buffer[SERIAL_IDX_ARG]);
+                break;
+            case SERIAL_CMD_SETTLING:
+                board_flash(LED_SERIAL);
+                settling_command(&serial.cmd_buffer[SERIAL_IDX_ARG]);
                 break;
             }
         }
@@ -331,6 +1541,23 @@ void UART_IRQHandler(void)
             case SERIAL_CMD_BACKFRAME:
             case SERIAL_CMD_EXECUTE_SEQ:
             case SERIAL_CMD_CORRUPT:
+            case SERIAL_CMD_SCAN:
+            case SERIAL_CMD_COMMISSION:
+            case SERIAL_CMD_MEMORY_BANK:
+            case SERIAL_CMD_JOB:
+            case SERIAL_CMD_MACRO:
+            case SERIAL_CMD_CONDITION:
+            case SERIAL_CMD_RESPONDER:
+            case SERIAL_CMD_GEAR:
+            case SERIAL_CMD_FILTER:
+            case SERIAL_CMD_OPTION:
+            case SERIAL_CMD_STATISTICS:
+            case SERIAL_CMD_URGENT:
+            case SERIAL_CMD_TIME:
+            case SERIAL_CMD_TRIGGER:
+            case SERIAL_CMD_CAPTURE:
+            case SERIAL_CMD_CALIBRATE:
+            case SERIAL_CMD_SETTLING:
                 buffer_index = 0;
                 active_buffer[0] = c;
                 break;
@@ -343,6 +1570,7 @@ void UART_IRQHandler(void)
                 buffer_index = 0;
                 break;
             case SERIAL_CHAR_EOL:
+                serial.receive_time = dali_101_get_time();
                 active_buffer[buffer_index] = '\000';
                 serial.cmd_buffer = active_buffer;
                 xTaskNotifyFromISR(serial.task_handle, SERIAL_NOTIFY_PROCESSS, eSetBits, &higher_priority_woken);
@@ -359,12 +1587,21 @@ void UART_IRQHandler(void)
     }
 }
 
-bool serial_get(struct dali_tx_frame* frame, TickType_t wait)
+bool serial_get(struct serial_request* request, TickType_t wait)
 {
-    const BaseType_t rc = xQueueReceive(serial.queue_handle, frame, wait);
+    const BaseType_t rc = xQueueReceive(serial.queue_handle, request, wait);
     return (rc == pdPASS);
 }
 
+void serial_done(const struct serial_request* request)
+{
+    if (sends_sequence(request)) {
+        taskENTER_CRITICAL();
+        serial.sequences--;
+        taskEXIT_CRITICAL();
+    }
+}
+
 static void serial_initialize_uart_interrupt(void)
 {
     LPC_UART->IER |= 0x01;
@@ -388,16 +1625,20 @@ static void serial_uart_init(void)
 
 void serial_init(void)
 {
+    static StaticSemaphore_t lock_buffer;
+    serial.output_lock = xSemaphoreCreateMutexStatic(&lock_buffer);
+    configASSERT(serial.output_lock);
+
     static StaticTask_t task_buffer;
     static StackType_t task_stack[SERIAL_TASK_STACKSIZE];
     serial.task_handle = xTaskCreateStatic(
         serial_task, "SERIAL", SERIAL_TASK_STACKSIZE, NULL, SERIAL_PRIORITY, task_stack, &task_buffer);
     configASSERT(serial.task_handle);
 
-    static uint8_t queue_storage[SERIAL_QUEUE_LENGTH * sizeof(struct dali_tx_frame)];
+    static uint8_t queue_storage[SERIAL_QUEUE_LENGTH * sizeof(struct serial_request)];
     static StaticQueue_t queue_buffer;
     serial.queue_handle =
-        xQueueCreateStatic(SERIAL_QUEUE_LENGTH, sizeof(struct dali_tx_frame), queue_storage, &queue_buffer);
+        xQueueCreateStatic(SERIAL_QUEUE_LENGTH, sizeof(struct serial_request), queue_storage, &queue_buffer);
     configASSERT(serial.queue_handle);
 
     serial_uart_init();
@@ -1,10 +1,96 @@
 #pragma once
-#include <stdbool.h>    // for bool
-#include "portmacro.h"  // for TickType_t
+#include <stdbool.h>                // for bool
+#include <stddef.h>                 // for size_t
+#include <stdint.h>                 // for uint8_t, uint32_t
+#include "portmacro.h"              // for TickType_t
+#include "dali_101_lpc/dali_101.h"  // for dali_tx_frame, dali_trigger
+#include "scan.h"                   // for scan_request
+#include "commission.h"             // for commission_request
+#include "memory_bank.h"            // for memory_bank_request
+#include "macro.h"                  // for macro_request
+#include "condition.h"              // for condition_request
+#include "cache.h"                  // for cache_request
+#include "calibrate.h"              // for calibrate_request
 struct dali_rx_frame;
-struct dali_tx_frame;
+
+#define SERIAL_BITMAP_SIZE (sizeof(uint64_t))
+
+// codes for block messages, see doc/messages.md
+enum serial_report {
+    SERIAL_REPORT_SCAN = 0xC0,
+    SERIAL_REPORT_COMMISSION_DEVICE = 0xC1,
+    SERIAL_REPORT_COMMISSION_DONE = 0xC2,
+    SERIAL_REPORT_MEMORY_READ = 0xC3,
+    SERIAL_REPORT_MEMORY_WRITE = 0xC4,
+    SERIAL_REPORT_JOB_RESULT = 0xC5,
+    SERIAL_REPORT_JOB_LIST = 0xC6,
+    SERIAL_REPORT_MACRO_REPLY = 0xC7,
+    SERIAL_REPORT_MACRO_DONE = 0xC8,
+    SERIAL_REPORT_CONDITION = 0xC9,
+    SERIAL_REPORT_GEAR_STATE = 0xCA,
+    SERIAL_REPORT_FILTER = 0xCB,
+    SERIAL_REPORT_ECHO = 0xCC,
+    SERIAL_REPORT_UTILISATION = 0xCD,
+    SERIAL_REPORT_TRAFFIC = 0xCE,
+    SERIAL_REPORT_MERGE = 0xCF,
+    SERIAL_REPORT_URGENT = 0xD0,
+    SERIAL_REPORT_DEVICE_TIME = 0xD1,
+    SERIAL_REPORT_EDGE_CAPTURE = 0xD2,
+    SERIAL_REPORT_TIME_SYNC = 0xD3,
+    SERIAL_REPORT_CALIBRATION = 0xD4,
+    SERIAL_REPORT_SETTINGS = 0xD5,
+    SERIAL_REPORT_TX_TIMING = 0xD6,
+    SERIAL_REPORT_SETTLING = 0xD7,
+    SERIAL_REPORT_START_TIMING = 0xD8,
+    SERIAL_REPORT_STACK = 0xD9,
+};
+
+enum serial_job {
+    SERIAL_JOB_FRAME = 0,       /**< send a single frame */
+    SERIAL_JOB_SCAN,            /**< run an address scan */
+    SERIAL_JOB_COMMISSION,      /**< run the random address search */
+    SERIAL_JOB_MEMORY_BANK,     /**< read or write a block of memory locations */
+    SERIAL_JOB_MACRO,           /**< execute a macro */
+    SERIAL_JOB_CONDITION,       /**< query and send a frame depending on the reply */
+    SERIAL_JOB_CACHED_QUERY,    /**< answer a query from the cache or send it */
+    SERIAL_JOB_TIMED_FRAME,     /**< send a single frame at a device time */
+    SERIAL_JOB_TRIGGERED_FRAME, /**< send a single frame after a foreign start bit */
+    SERIAL_JOB_CALIBRATE,       /**< calibrate the receiver with frames sent by the interface */
+    SERIAL_JOB_SAVE_SETTINGS,   /**< store the calibration in the flash */
+};
+
+struct serial_timed_frame {
+    struct dali_tx_frame frame; /**< frame to send */
+    uint32_t time_us;           /**< device time of the start in microseconds */
+};
+
+struct serial_triggered_frame {
+    struct dali_tx_frame frame;  /**< frame to send */
+    struct dali_trigger trigger; /**< trigger condition */
+};
+
+struct serial_request {
+    enum serial_job job;
+    union {
+        struct dali_tx_frame frame;
+        struct scan_request scan;
+        struct commission_request commission;
+        struct memory_bank_request memory_bank;
+        struct macro_request macro;
+        struct condition_request condition;
+        struct cache_request cached_query;
+        struct serial_timed_frame timed_frame;
+        struct serial_triggered_frame triggered_frame;
+        struct calibrate_request calibrate;
+    };
+};
 
 void serial_print_head(void);
 void serial_print_frame(struct dali_rx_frame frame);
-bool serial_get(struct dali_tx_frame* frame, TickType_t wait);
+void serial_print_block(enum serial_report code, const uint8_t* data, size_t length);
+void serial_put_bitmap(uint8_t* buffer, uint64_t bitmap);
+void serial_put_uint32(uint8_t* buffer, uint32_t value);
+bool serial_get(struct serial_request* request, TickType_t wait);
+void serial_done(const struct serial_request* request);
+bool serial_urgent_is_pending(void);
 void serial_init (void);
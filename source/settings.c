@@ -0,0 +1,81 @@
+#include <stdbool.h> // for bool
+#include <stddef.h>  // for size_t
+#include <stdint.h>  // for uint8_t, uint32_t, int32_t
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "board/dali.h"
+#include "board/iap.h"
+#include "bus.h"
+#include "dali_101_lpc/dali_101.h"
+#include "serial.h"
+#include "settings.h"
+
+// "DALI", the version changes with the layout of the record
+#define SETTINGS_MAGIC (0x44414C49U)
+#define SETTINGS_VERSION (3U)
+
+enum settings_result { SETTINGS_SAVED = 0, SETTINGS_FAILED };
+
+struct _record {
+    uint32_t magic;
+    uint32_t version;
+    int32_t rx_asymmetry_us;
+    int32_t tx_compensation_us[DALI_PHASES];
+    struct dali_settling_times settling;
+    uint32_t checksum;
+};
+
+_Static_assert(sizeof(struct _record) <= BOARD_IAP_PAGE_SIZE, "settings record exceeds the flash page");
+
+static uint32_t get_checksum(const struct _record* record)
+{
+    const uint32_t* word = (const uint32_t*)record;
+    uint32_t checksum = 0;
+    for (size_t i = 0; i < offsetof(struct _record, checksum) / sizeof(uint32_t); i++) {
+        checksum = (checksum << 1U | checksum >> 31U) ^ word[i];
+    }
+    return ~checksum;
+}
+
+void settings_defaults(void)
+{
+    dali_101_set_rx_asymmetry(DALI_RX_FALL_US - DALI_RX_RISE_US);
+    dali_101_set_tx_compensation(DALI_PHASE_ACTIVE, -(DALI_TX_RISE_US + DALI_TX_FALL_US));
+    dali_101_set_tx_compensation(DALI_PHASE_IDLE, DALI_TX_RISE_US + DALI_TX_FALL_US);
+}
+
+void settings_load(void)
+{
+    const struct _record* record = (const struct _record*)BOARD_IAP_STORAGE_ADDRESS;
+    if (record->magic != SETTINGS_MAGIC || record->version != SETTINGS_VERSION ||
+        record->checksum != get_checksum(record)) {
+        return;
+    }
+    dali_101_set_rx_asymmetry(record->rx_asymmetry_us);
+    for (enum dali_phase phase = DALI_PHASE_IDLE; phase < DALI_PHASES; phase++) {
+        dali_101_set_tx_compensation(phase, record->tx_compensation_us[phase]);
+    }
+    dali_101_set_settling_times(&record->settling);
+}
+
+// The flash is written from the record on the stack. A write always copies a whole page, the
+// RAM behind the record ends up in the rest of the page, which is never read.
+void settings_save(void)
+{
+    struct _record record = { .magic = SETTINGS_MAGIC,
+                              .version = SETTINGS_VERSION,
+                              .rx_asymmetry_us = dali_101_get_rx_asymmetry() };
+    for (enum dali_phase phase = DALI_PHASE_IDLE; phase < DALI_PHASES; phase++) {
+        record.tx_compensation_us[phase] = dali_101_get_tx_compensation(phase);
+    }
+    dali_101_get_settling_times(&record.settling);
+    record.checksum = get_checksum(&record);
+    // the timers of the driver do not run their interrupts while the flash is written
+    bus_suspend_when_quiet();
+    const bool saved = board_iap_write_storage((const uint32_t*)&record);
+    xTaskResumeAll();
+    const uint8_t result[1] = { saved ? SETTINGS_SAVED : SETTINGS_FAILED };
+    serial_print_block(SERIAL_REPORT_SETTINGS, result, sizeof(result));
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+/**
+ * @brief Restore the default calibration of the driver, the settling times and the stored settings are kept
+ *
+ */
+void settings_defaults(void);
+
+/**
+ * @brief Apply the stored settings to the driver, if there are valid settings. Call after `dali_101_init`.
+ *
+ */
+void settings_load(void);
+
+/**
+ * @brief Store the current calibration and settling times of the driver in the flash and report the result
+ *        with a block message. Must be called from the main task.
+ *
+ * The flash is written when no frame is on the bus and none is pending. Interrupts are disabled
+ * for about 100 ms, frames on the bus and characters received by the serial interface during
+ * this time are lost.
+ */
+void settings_save(void);
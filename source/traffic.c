@@ -0,0 +1,169 @@
+#include <stdbool.h> // for bool, false, true
+#include <stdint.h>  // for uint8_t, uint16_t, uint32_t, uint_fast8_t
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "dali_101_lpc/dali_101.h"
+#include "serial.h"
+#include "traffic.h"
+
+#define TRAFFIC_SHORT_ADDRESSES (64U)
+#define TRAFFIC_GROUPS (16U)
+#define TRAFFIC_BROADCAST (TRAFFIC_SHORT_ADDRESSES + TRAFFIC_GROUPS)
+#define TRAFFIC_TARGETS (TRAFFIC_BROADCAST + 1U)
+#define TRAFFIC_NO_TARGET (0xFFU)
+#define TRAFFIC_TOTAL (0xFFU)
+#define TRAFFIC_FORWARD_LENGTH (16U)
+#define TRAFFIC_BACKWARD_LENGTH (8U)
+// IEC 62386-102 queries from QUERY STATUS to READ MEMORY LOCATION, the application extended
+// commands E0..FF depend on the device type and are not counted as queries
+#define TRAFFIC_FIRST_QUERY (0x90U)
+#define TRAFFIC_LAST_QUERY (0xC5U)
+#define TRAFFIC_REPORT_SIZE (9U)
+
+// 8 bit counters keep the table small, the RAM of the LPC1114 is scarce
+struct _counters {
+    uint8_t forward;
+    uint8_t answered;
+    uint8_t timeout;
+    uint8_t error;
+};
+
+struct _totals {
+    uint16_t forward;
+    uint16_t answered;
+    uint16_t timeout;
+    uint16_t error;
+};
+
+// counters are updated by the receiver task inside critical sections,
+// the other tasks only queue error frames now and then
+static struct _traffic {
+    struct _counters target[TRAFFIC_TARGETS];
+    uint8_t last_target;
+    bool query_pending;
+} traffic;
+
+void traffic_init(void)
+{
+    traffic.last_target = TRAFFIC_NO_TARGET;
+}
+
+static void increment(uint8_t* counter)
+{
+    if (*counter < UINT8_MAX) {
+        (*counter)++;
+    }
+}
+
+static uint8_t get_target(uint8_t address)
+{
+    if ((address & 0x80U) == 0) {
+        return address >> 1U;
+    }
+    if ((address & 0xE0U) == 0x80U) {
+        return TRAFFIC_SHORT_ADDRESSES + ((address >> 1U) & 0x0FU);
+    }
+    if ((address & 0xFCU) == 0xFCU) {
+        return TRAFFIC_BROADCAST;
+    }
+    return TRAFFIC_NO_TARGET;
+}
+
+static void close_query(bool answered)
+{
+    if (traffic.query_pending) {
+        increment(answered ? &traffic.target[traffic.last_target].answered
+                           : &traffic.target[traffic.last_target].timeout);
+        traffic.query_pending = false;
+    }
+}
+
+static void count_forward_frame(uint32_t data)
+{
+    const uint8_t address = data >> 8U;
+    const uint8_t opcode = data;
+    close_query(false);
+    traffic.last_target = get_target(address);
+    if (traffic.last_target == TRAFFIC_NO_TARGET) {
+        return;
+    }
+    increment(&traffic.target[traffic.last_target].forward);
+    traffic.query_pending =
+        ((address & 0x01U) && opcode >= TRAFFIC_FIRST_QUERY && opcode <= TRAFFIC_LAST_QUERY);
+}
+
+static void count_error_frame(void)
+{
+    if (traffic.last_target == TRAFFIC_NO_TARGET) {
+        return;
+    }
+    increment(&traffic.target[traffic.last_target].error);
+    traffic.last_target = TRAFFIC_NO_TARGET;
+    traffic.query_pending = false;
+}
+
+void traffic_observe(const struct dali_rx_frame* frame)
+{
+    taskENTER_CRITICAL();
+    switch (frame->status) {
+    case DALI_OK:
+        if (frame->length == TRAFFIC_FORWARD_LENGTH) {
+            count_forward_frame(frame->data);
+        } else if (frame->length == TRAFFIC_BACKWARD_LENGTH) {
+            close_query(true);
+        }
+        break;
+    case DALI_TIMEOUT:
+        close_query(false);
+        break;
+    default:
+        count_error_frame();
+        break;
+    }
+    taskEXIT_CRITICAL();
+}
+
+// 81 targets of at most FF each can not overflow the 16 bit totals
+static void add_counters(struct _totals* total, const struct _counters* counters)
+{
+    total->forward += counters->forward;
+    total->answered += counters->answered;
+    total->timeout += counters->timeout;
+    total->error += counters->error;
+}
+
+static void print_counters(uint8_t target, const struct _totals* counters)
+{
+    const uint8_t result[TRAFFIC_REPORT_SIZE] = { target,
+                                                  counters->forward >> 8U,
+                                                  counters->forward,
+                                                  counters->answered >> 8U,
+                                                  counters->answered,
+                                                  counters->timeout >> 8U,
+                                                  counters->timeout,
+                                                  counters->error >> 8U,
+                                                  counters->error };
+    serial_print_block(SERIAL_REPORT_TRAFFIC, result, sizeof(result));
+}
+
+void traffic_report(bool reset)
+{
+    struct _totals total = { 0 };
+    for (uint_fast8_t i = 0; i < TRAFFIC_TARGETS; i++) {
+        taskENTER_CRITICAL();
+        const struct _counters counters = traffic.target[i];
+        if (reset) {
+            traffic.target[i] = (struct _counters){ 0 };
+        }
+        taskEXIT_CRITICAL();
+        if (counters.forward || counters.error) {
+            struct _totals target = { 0 };
+            add_counters(&target, &counters);
+            print_counters(i, &target);
+            add_counters(&total, &counters);
+        }
+    }
+    print_counters(TRAFFIC_TOTAL, &total);
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <stdbool.h>               // for bool
+#include "dali_101_lpc/dali_101.h" // for dali_rx_frame
+
+/**
+ * @brief Reset the address of the last forward frame. Must be called before the receiver starts.
+ *
+ */
+void traffic_init(void);
+
+/**
+ * @brief Report the traffic counters of all short addresses, groups and broadcast
+ *
+ * One block message is output for each address with traffic, followed by the totals.
+ *
+ * @param reset `true` - reset the counters after the report
+ */
+void traffic_report(bool reset);
+
+/**
+ * @brief Count a received frame for the address of the last forward frame
+ *
+ * Called from the receiver task, see `dali_101_observer`.
+ */
+void traffic_observe(const struct dali_rx_frame* frame);
@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+"""Convert the edge capture stream of the DALI USB adapter into a VCD waveform file.
+
+The adapter streams captured edges with block message `D2`, see command `%` and
+doc/messages.md. Capture from the adapter directly, or convert a log of the serial output:
+
+    capture_to_vcd.py --port /dev/ttyUSB0 --seconds 10 capture.vcd
+    capture_to_vcd.py --log serial.log capture.vcd
+    capture_to_vcd.py --port /dev/ttyUSB0 --arm "s20 83" capture.vcd
+
+The signal `bus` is the level of the DALI bus: 1 - idle (high), 0 - active (low),
+x - unknown after lost edges. The signal `trigger` pulses when a triggered capture fires.
+"""
+import argparse
+import re
+import time
+
+BLOCK = re.compile(r"\{([0-9a-f]{8})#d2 ([0-9a-f]*)\}")
+
+CAPTURE_START = 0
+CAPTURE_EDGES = 1
+CAPTURE_LOST = 2
+CAPTURE_STOP = 3
+CAPTURE_TRIGGER = 4
+
+
+def read_varints(data: bytes):
+    value = 0
+    shift = 0
+    for byte in data:
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            yield value
+            value = 0
+            shift = 0
+
+
+class VcdWriter:
+    def __init__(self, file) -> None:
+        self.file = file
+        self.time_us = None
+        self.start_us = 0
+        self.edges = 0
+        self.lost = 0
+        file.write(f"$date {time.asctime()} $end\n")
+        file.write("$version DALI USB adapter edge capture $end\n")
+        file.write("$timescale 1us $end\n")
+        file.write("$scope module dali $end\n")
+        file.write("$var wire 1 ! bus $end\n")
+        file.write("$var event 1 * trigger $end\n")
+        file.write("$upscope $end\n")
+        file.write("$enddefinitions $end\n")
+
+    def change(self, time_us: int, value: str) -> None:
+        self.file.write(f"#{time_us}\n{value}!\n")
+
+    def receive(self, data: bytes) -> None:
+        kind = data[0]
+        if kind == CAPTURE_START:
+            self.time_us = 0
+            self.start_us = int.from_bytes(data[1:5], "big")
+            active = data[5]
+            self.change(self.time_us, "0" if active else "1")
+        elif self.time_us is None:
+            # stream was joined after the start message
+            return
+        elif kind == CAPTURE_EDGES:
+            for value in read_varints(data[1:]):
+                self.time_us += value >> 1
+                self.change(self.time_us, "0" if value & 1 else "1")
+                self.edges += 1
+        elif kind == CAPTURE_TRIGGER:
+            trigger_us = (int.from_bytes(data[5:9], "big") - self.start_us) & 0xFFFFFFFF
+            self.file.write(f"#{trigger_us}\n1*\n")
+        elif kind == CAPTURE_LOST:
+            self.lost += int.from_bytes(data[1:5], "big")
+            self.change(self.time_us + 1, "x")
+        elif kind == CAPTURE_STOP:
+            self.time_us = None
+
+
+def convert_line(line: str, writer: VcdWriter) -> bool:
+    match = BLOCK.search(line)
+    if not match:
+        return False
+    data = bytes.fromhex(match.group(2))
+    writer.receive(data)
+    return data[0] == CAPTURE_STOP
+
+
+def capture_from_port(port_name: str, seconds: float, arm: str, writer: VcdWriter) -> None:
+    import serial
+
+    port = serial.Serial(port=port_name, baudrate=500000, timeout=0.2)
+    if arm:
+        # wait for the trigger, the capture stops on its own
+        port.write(f"%{arm}\r".encode("utf-8"))
+        while not convert_line(port.readline().decode("utf-8", errors="replace"), writer):
+            pass
+        return
+    port.write("%1\r".encode("utf-8"))
+    end = time.monotonic() + seconds
+    stopping = False
+    while True:
+        if not stopping and time.monotonic() > end:
+            port.write("%0\r".encode("utf-8"))
+            stopping = True
+        line = port.readline().decode("utf-8", errors="replace")
+        if convert_line(line, writer):
+            break
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--port", help="serial port of the adapter")
+    source.add_argument("--log", help="file with the serial output of the adapter")
+    parser.add_argument("--seconds", type=float, default=5.0, help="capture duration, default 5 seconds")
+    parser.add_argument("--arm", help="arguments of a triggered capture, e.g. 's20 83', waits for the trigger")
+    parser.add_argument("output", help="VCD file to write")
+    args = parser.parse_args()
+
+    with open(args.output, "w") as file:
+        writer = VcdWriter(file)
+        if args.port:
+            capture_from_port(args.port, args.seconds, args.arm, writer)
+        else:
+            with open(args.log) as log:
+                for line in log:
+                    convert_line(line, writer)
+    print(f"{writer.edges} edges written, {writer.lost} edges lost")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+import re
+import serial
+import time
+
+ENGINE_DATA = 0xFF00
+OWN_DATA = 0xFF01
+ENGINE_STEPS = 3
+COUNTER_PERIOD_MS = 0x64
+STEP_DELAY_SEC = 0.1
+READ_TIME_SEC = 0.3
+
+FRAME = re.compile(r"\{([0-9a-f]{8})([:>])([0-9a-f]{2}) ([0-9a-f]{8})\}")
+COUNTERS = re.compile(r"\{([0-9a-f]{8})#cc ([0-9a-f]{8})([0-9a-f]{8})([0-9a-f]{8})\}")
+
+
+def read_lines(port):
+    lines = []
+    end = time.monotonic() + READ_TIME_SEC
+    while time.monotonic() < end:
+        line = port.readline().decode("utf-8", errors="replace").strip()
+        if line:
+            lines.append(line)
+    return lines
+
+
+def setup_macro():
+    serial_0_port.write(b"Uc0\r")
+    for _ in range(ENGINE_STEPS):
+        serial_0_port.write(f"Ua0 s1 10 {ENGINE_DATA:X}\r".encode("utf-8"))
+    read_lines(serial_0_port)
+
+
+def engine_frame_then_foreign_frame():
+    # enabling the suppression resets the counters
+    serial_0_port.write(f"Oe1 {COUNTER_PERIOD_MS:X}\r".encode("utf-8"))
+    serial_0_port.write(b"Ux0\r")
+    time.sleep(STEP_DELAY_SEC)
+    serial_1_port.write(f"S1 10 {ENGINE_DATA:X}\r".encode("utf-8"))
+    time.sleep(STEP_DELAY_SEC)
+    serial_0_port.write(f"S1 10 {OWN_DATA:X}\r".encode("utf-8"))
+    frames = []
+    counters = None
+    for line in read_lines(serial_0_port):
+        match = FRAME.search(line)
+        if match:
+            frames.append((match.group(2), int(match.group(3), 16), int(match.group(4), 16)))
+            continue
+        match = COUNTERS.search(line)
+        if match:
+            counters = (int(match.group(2), 16), int(match.group(3), 16), int(match.group(4), 16))
+    expected = [(":", 0x10, ENGINE_DATA)]
+    if frames != expected or counters != (1, 0, 0):
+        print(f"failed: frames {frames}, counters {counters}")
+        return False
+    return True
+
+
+print("ENGINE FRAME FOLLOWED BY AN IDENTICAL FOREIGN FRAME")
+print("To execute please connect the following:")
+print("* two DALI / USB adapter, enumerating as ttyUSB0 and ttyUSB1")
+print("* a DALI power supply")
+print("Adapter 0 sends frames from a macro, adapter 1 sends a frame with the same data.")
+print("The foreign frame must be output, the loopback of the next frame of adapter 0")
+print("must be suppressed and no stale expectation may be counted.")
+
+serial_0_portname = "/dev/ttyUSB0"
+serial_1_portname = "/dev/ttyUSB1"
+
+print("open serial ports")
+serial_0_port = serial.Serial(port=serial_0_portname, baudrate=500000, timeout=0.05)
+serial_1_port = serial.Serial(port=serial_1_portname, baudrate=500000, timeout=0.05)
+
+print("start test sequence")
+setup_macro()
+failed = 0
+for i in range(100):
+    if not engine_frame_then_foreign_frame():
+        failed += 1
+    read_lines(serial_1_port)
+serial_0_port.write(b"Oe0\r")
+print(f"{failed} of 100 failed")
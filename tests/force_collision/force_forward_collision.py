@@ -2,13 +2,15 @@
 import serial
 import time
 
+ARM_DELAY_SEC = 0.01
+
 
 def send_spaced_backframes(spacing_us):
-    mu_sec = 0.000001
     print(f"send backframes with {spacing_us} us spacing")
+    # the second adapter starts its frame with microsecond precision after the start bit of the first one
+    serial_1_port.write(f"^s{spacing_us:X} 0 0 1 10 FFFF\r".encode("utf-8"))
+    time.sleep(ARM_DELAY_SEC)
     serial_0_port.write("S1 10 0000\r".encode("utf-8"))
-    time.sleep(spacing_us * mu_sec)
-    serial_1_port.write("S1 10 FFFF\r".encode("utf-8"))
     time.sleep(0.2)
 
 
@@ -0,0 +1,65 @@
+#!/usr/bin/env python3
+import re
+import serial
+import time
+
+FOREIGN_DATA = 0xFFFFFFFF
+URGENT_DATA = 0xFF00
+START_DELAY_SEC = 0.008
+READ_TIME_SEC = 0.3
+
+FRAME = re.compile(r"\{([0-9a-f]{8})([:>])([0-9a-f]{2}) ([0-9a-f]{8})\}")
+BLOCK = re.compile(r"\{([0-9a-f]{8})#d0 ([0-9a-f]*)\}")
+
+
+def read_lines(port):
+    lines = []
+    end = time.monotonic() + READ_TIME_SEC
+    while time.monotonic() < end:
+        line = port.readline().decode("utf-8", errors="replace").strip()
+        if line:
+            lines.append(line)
+    return lines
+
+
+def send_urgent_during_foreign_frame():
+    # the foreign frame with 32 data bits is on the bus for about 27 ms
+    serial_1_port.write(f"S1 20 {FOREIGN_DATA:X}\r".encode("utf-8"))
+    time.sleep(START_DELAY_SEC)
+    serial_0_port.write(f"!10 {URGENT_DATA:X}\r".encode("utf-8"))
+    frames = []
+    reports = 0
+    for line in read_lines(serial_0_port):
+        match = FRAME.search(line)
+        if match:
+            frames.append((match.group(2), int(match.group(3), 16), int(match.group(4), 16)))
+        elif BLOCK.search(line):
+            reports += 1
+    expected = [(":", 0x20, FOREIGN_DATA), (">", 0x10, URGENT_DATA)]
+    if frames != expected or reports != 1:
+        print(f"failed: frames {frames}, urgent reports {reports}")
+        return False
+    return True
+
+
+print("URGENT FRAME DURING A FOREIGN FRAME")
+print("To execute please connect the following:")
+print("* two DALI / USB adapter, enumerating as ttyUSB0 and ttyUSB1")
+print("* a DALI power supply")
+print("The urgent frame of adapter 0 must follow the foreign frame of adapter 1,")
+print("both frames must be received without error.")
+
+serial_0_portname = "/dev/ttyUSB0"
+serial_1_portname = "/dev/ttyUSB1"
+
+print("open serial ports")
+serial_0_port = serial.Serial(port=serial_0_portname, baudrate=500000, timeout=0.05)
+serial_1_port = serial.Serial(port=serial_1_portname, baudrate=500000, timeout=0.05)
+
+print("start test sequence")
+failed = 0
+for i in range(100):
+    if not send_urgent_during_foreign_frame():
+        failed += 1
+    read_lines(serial_1_port)
+print(f"{failed} of 100 failed")
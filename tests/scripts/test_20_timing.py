@@ -213,3 +213,37 @@ def test_3_11_receiver_bit_timing(dali_serial):
             assert result.status == DaliStatus.LOOPBACK
             assert result.data == 0xF0
             assert result.length == 8
+
+
+@pytest.mark.parametrize(
+    "priority, settling",
+    [
+        (1, 13500),
+        (3, 16300),
+        (5, 19500),
+    ],
+)
+def test_sequence_settling_priority(dali_serial, priority, settling):
+    std_halfbit_period = 417
+    bits = [std_halfbit_period] * 17
+    dali_serial.port.write(f"W{bits[0]:x}\r".encode("utf-8"))
+    time.sleep(time_for_command_processing)
+    for period in bits[1:]:
+        dali_serial.port.write(f"N{period:x}\r".encode("utf-8"))
+        time.sleep(time_for_command_processing)
+    dali_serial.port.write("S1 10 00FF\r".encode("utf-8"))
+    time.sleep(time_for_command_processing)
+    dali_serial.port.write(f"X{priority:x}\r".encode("utf-8"))
+    result = dali_serial.get(timeout_time_sec)
+    assert result.status == DaliStatus.LOOPBACK
+    timestamp_1 = result.timestamp
+    result = dali_serial.get(timeout_time_sec)
+    assert result.status == DaliStatus.LOOPBACK
+    assert result.length == 8
+    assert result.data == 0xFF
+    delta = result.timestamp - timestamp_1
+    fullbit_time = 833 / 1000000
+    expected_delta = 17 * fullbit_time + (settling / 1000000)
+    tolerance = 1 / 1000
+    logger.debug(f"delta is {delta} expected is {expected_delta}")
+    assert (abs(delta - expected_delta)) < tolerance
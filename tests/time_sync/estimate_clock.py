@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+"""Estimate offset and drift of the device clock of a DALI USB adapter against the host clock.
+
+The host sends its time with command `Tc`, the adapter replies with block message `D3`
+carrying the device times when the command was received and when the reply was sent.
+As with NTP, the exchanges with the shortest round trip are the least disturbed by the
+latency of the USB serial converter. A line fitted through them gives offset and drift.
+
+    estimate_clock.py --port /dev/ttyUSB0
+    estimate_clock.py --port /dev/ttyUSB0 --apply
+
+With `--apply` the estimate is sent to the adapter with command `Ta`, and the frame and
+block messages are switched to host aligned timestamps with option `Ot2`. The timestamps
+are then the lower 32 bits of the host time in microseconds since the epoch. Repeat the
+estimate every few minutes to follow a changing drift.
+"""
+import argparse
+import re
+import time
+
+import serial
+
+SYNC = re.compile(r"\{[0-9a-f]{8}#d3 ([0-9a-f]{8})([0-9a-f]{8})([0-9a-f]{8})\}")
+WRAP = 1 << 32
+BEST_FRACTION = 0.25
+
+
+def host_time_us() -> int:
+    return time.time_ns() // 1000
+
+
+def exchange(port):
+    t1 = host_time_us()
+    token = t1 % WRAP
+    port.write(f"Tc{token:X}\r".encode("utf-8"))
+    while True:
+        line = port.readline().decode("utf-8", errors="replace")
+        t4 = host_time_us()
+        if not line:
+            return None
+        match = SYNC.search(line)
+        if match and int(match.group(1), 16) == token:
+            return t1, int(match.group(2), 16), int(match.group(3), 16), t4
+
+
+class Unwrap:
+    """Extend the 32 bit device time, the exchanges must be less than 71 minutes apart."""
+
+    def __init__(self) -> None:
+        self.last = None
+        self.high = 0
+
+    def __call__(self, value: int) -> int:
+        if self.last is not None and value < self.last and self.last - value > WRAP // 2:
+            self.high += WRAP
+        self.last = value
+        return self.high + value
+
+
+def fit(samples):
+    n = len(samples)
+    mean_x = sum(x for x, _ in samples) / n
+    mean_y = sum(y for _, y in samples) / n
+    sxx = sum((x - mean_x) ** 2 for x, _ in samples)
+    sxy = sum((x - mean_x) * (y - mean_y) for x, y in samples)
+    slope = sxy / sxx if sxx else 1.0
+    return mean_y - slope * mean_x, slope
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", default="/dev/ttyUSB0", help="serial port of the adapter")
+    parser.add_argument("--count", type=int, default=100, help="number of exchanges, default 100")
+    parser.add_argument("--interval", type=float, default=0.1, help="seconds between exchanges, default 0.1")
+    parser.add_argument("--apply", action="store_true", help="send the estimate to the adapter")
+    args = parser.parse_args()
+
+    port = serial.Serial(port=args.port, baudrate=500000, timeout=0.2)
+    unwrap = Unwrap()
+    exchanges = []
+    for _ in range(args.count):
+        result = exchange(port)
+        if result:
+            t1, t2, t3, t4 = result
+            t2 = unwrap(t2)
+            t3 = t2 + ((t3 - t2) % WRAP)
+            delay = (t4 - t1) - (t3 - t2)
+            exchanges.append((delay, (t2 + t3) / 2, (t1 + t4) / 2))
+        time.sleep(args.interval)
+    if len(exchanges) < 4:
+        print(f"only {len(exchanges)} replies, check the connection")
+        return
+
+    exchanges.sort()
+    best = exchanges[: max(4, int(len(exchanges) * BEST_FRACTION))]
+    samples = [(device, host) for _, device, host in best]
+    origin = samples[0][0]
+    intercept, slope = fit([(device - origin, host) for device, host in samples])
+    residual = max(abs(host - (intercept + slope * (device - origin))) for device, host in samples)
+    drift_ppb = round((slope - 1.0) * 1e9)
+    device_ref = max(device for device, _ in samples)
+    host_ref = round(intercept + slope * (device_ref - origin))
+    offset = host_ref - device_ref
+
+    print(f"{len(exchanges)} exchanges, round trip {best[0][0]} .. {exchanges[-1][0]} us")
+    print(f"offset {offset} us, drift {drift_ppb / 1000:.3f} ppm, residual {residual:.0f} us")
+    if args.apply:
+        device_ref = round(device_ref) % WRAP
+        drift = f"-{-drift_ppb:X}" if drift_ppb < 0 else f"{drift_ppb:X}"
+        port.write(f"Ta{device_ref:X} {host_ref % WRAP:X} {drift}\r".encode("utf-8"))
+        port.write("Ot2\r".encode("utf-8"))
+        print("host aligned timestamps enabled")
+
+
+if __name__ == "__main__":
+    main()
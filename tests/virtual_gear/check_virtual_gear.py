@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+import random
+import re
+import serial
+import time
+
+from gear_model import CORRUPT, GearModel
+
+FRAME = re.compile(r"\{([0-9a-f]{8})([>:])([0-9a-f]{2}) ([0-9a-f]{8})\}")
+DALI_OK_LENGTH = 0x08
+DALI_TIMEOUT = 0x81
+FRAME_SPACING_SEC = 0.12
+
+SHORT_ADDRESSES = (0x00, 0x01, 0xFF)
+ADDRESS_BYTES = (0x01, 0x03, 0x81, 0xFD, 0xFF)
+COMMANDS = (0x00, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x10, 0x11)
+CONFIGURATIONS = (0x20, 0x21, 0x2A, 0x2B, 0x2C, 0x2D, 0x40, 0x41, 0x50, 0x60, 0x61, 0x70, 0x81)
+QUERIES = (0x90, 0x91, 0x93, 0x94, 0x95, 0x96, 0x98, 0x9C, 0xA0, 0xA1, 0xA2, 0xA3, 0xB0, 0xC0, 0xC5)
+
+
+def read_frame(port):
+    while True:
+        line = port.readline().decode("utf-8")
+        if not line:
+            return None
+        match = FRAME.search(line)
+        if match:
+            return match.group(2), int(match.group(3), 16), int(match.group(4), 16)
+
+
+def send(data, twice):
+    controller.write(f"S1 10{'+' if twice else ' '}{data:04X}\r".encode("utf-8"))
+    for _ in range(2 if twice else 1):
+        read_frame(controller)
+    model.receive(data, False)
+    if twice:
+        model.receive(data, True)
+    time.sleep(FRAME_SPACING_SEC)
+
+
+def query(data):
+    controller.write(f"Q1 10 {data:04X}\r".encode("utf-8"))
+    read_frame(controller)
+    reply = read_frame(controller)
+    expected = model.receive(data, False)
+    if reply is None:
+        return False
+    _, length, value = reply
+    time.sleep(FRAME_SPACING_SEC)
+    if length == DALI_TIMEOUT:
+        return expected is None
+    if length == DALI_OK_LENGTH:
+        return expected == value
+    return expected == CORRUPT
+
+
+def random_step():
+    address = random.choice(ADDRESS_BYTES)
+    kind = random.randrange(5)
+    if kind == 0:
+        send(((address & 0xFE) << 8) | random.randrange(256), False)
+    elif kind == 1:
+        send((address << 8) | random.choice(COMMANDS), False)
+    elif kind == 2:
+        send((address << 8) | random.choice(CONFIGURATIONS), True)
+    elif kind == 3:
+        send((random.choice((0xA3, 0xC3, 0xC5)) << 8) | random.randrange(256), False)
+    else:
+        data = (address << 8) | random.choice(QUERIES)
+        if not query(data):
+            print(f"unexpected answer to {data:04X}")
+            return False
+    return True
+
+
+print("CHECK VIRTUAL CONTROL GEAR")
+print("To execute please connect the following:")
+print("* two DALI / USB adapter, enumerating as ttyUSB0 and ttyUSB1")
+print("* a DALI power supply")
+print("The adapter on ttyUSB1 emulates the control gear, the adapter")
+print("on ttyUSB0 controls them. The answers are compared with the model.")
+
+controller = serial.Serial(port="/dev/ttyUSB0", baudrate=500000, timeout=0.2)
+emulator = serial.Serial(port="/dev/ttyUSB1", baudrate=500000, timeout=0.2)
+model = GearModel()
+
+emulator.write("Vc\r".encode("utf-8"))
+for short_address in SHORT_ADDRESSES:
+    emulator.write(f"Va{short_address:X}\r".encode("utf-8"))
+    model.add(short_address)
+time.sleep(FRAME_SPACING_SEC)
+
+random.seed(2024)
+failures = 0
+for i in range(2000):
+    if not random_step():
+        failures += 1
+print(f"{failures} unexpected answers")
@@ -0,0 +1,309 @@
+"""Golden model of the virtual control gear, see command `V`.
+
+The model mirrors the behaviour the firmware implements for IEC 62386-102
+control gear. It is used to predict the answers of the emulated control gear.
+"""
+
+MASK = 0xFF
+YES = 0xFF
+PHYSICAL_MIN_LEVEL = 1
+MAX_LEVEL = 254
+RANDOM_RESET = 0xFFFFFF
+BANK_0 = [0x12, 0x00, 0x01] + [0x00] * 6 + [0x01, 0x00] + [0x00] * 8
+BANK_1_LAST_LOCATION = 0x05
+BANK_1_LOCK_LOCATION = 0x02
+BANK_1_FIRST_DATA_LOCATION = 0x03
+BANK_1_UNLOCK = 0x55
+
+# answer of all control gear collide
+CORRUPT = -1
+
+
+class Gear:
+    def __init__(self, index: int, short_address: int) -> None:
+        self.index = index
+        self.short_address = short_address
+        self.dtr = [0, 0, 0]
+        self.lock_byte = 0xFF
+        self.bank_1 = [0] * (BANK_1_LAST_LOCATION - BANK_1_FIRST_DATA_LOCATION + 1)
+        self.initialise = False
+        self.withdrawn = False
+        self.write_enabled = False
+        self.reset()
+        self.power_cycle_seen = True
+
+    def reset(self) -> None:
+        self.random_address = RANDOM_RESET
+        self.groups = 0
+        self.scene = [MASK] * 16
+        self.actual_level = MAX_LEVEL
+        self.max_level = MAX_LEVEL
+        self.min_level = PHYSICAL_MIN_LEVEL
+        self.power_on_level = MAX_LEVEL
+        self.system_failure_level = MAX_LEVEL
+        self.limit_error = False
+        self.power_cycle_seen = False
+
+    def is_reset_state(self) -> bool:
+        return (
+            all(level == MASK for level in self.scene)
+            and self.random_address == RANDOM_RESET
+            and self.groups == 0
+            and self.actual_level == MAX_LEVEL
+            and self.max_level == MAX_LEVEL
+            and self.min_level == PHYSICAL_MIN_LEVEL
+            and self.power_on_level == MAX_LEVEL
+            and self.system_failure_level == MAX_LEVEL
+        )
+
+    def status(self) -> int:
+        status = 0
+        if self.actual_level:
+            status |= 1 << 2
+        if self.limit_error:
+            status |= 1 << 3
+        if self.is_reset_state():
+            status |= 1 << 5
+        if self.short_address == MASK:
+            status |= 1 << 6
+        if self.power_cycle_seen:
+            status |= 1 << 7
+        return status
+
+    def set_level(self, level: int) -> None:
+        if level == MASK:
+            return
+        self.limit_error = False
+        if level and level < self.min_level:
+            level = self.min_level
+            self.limit_error = True
+        if level > self.max_level:
+            level = self.max_level
+            self.limit_error = True
+        self.actual_level = level
+
+    def is_addressed(self, address: int) -> bool:
+        if address & 0x80 == 0:
+            return (address >> 1) == self.short_address
+        if address & 0xE0 == 0x80:
+            return bool(self.groups & (1 << ((address >> 1) & 0x0F)))
+        if address & 0xFE == 0xFC:
+            return self.short_address == MASK
+        return address & 0xFE == 0xFE
+
+    def set_short_address(self, data: int) -> None:
+        if data == MASK:
+            self.short_address = MASK
+        elif data & 0x81 == 0x01:
+            self.short_address = data >> 1
+
+    def increment_dtr0(self) -> None:
+        if self.dtr[0] < 0xFF:
+            self.dtr[0] += 1
+
+    def read_memory(self):
+        bank, location = self.dtr[1], self.dtr[0]
+        if bank == 0 and location < len(BANK_0):
+            return self.index if location == len(BANK_0) - 1 else BANK_0[location]
+        if bank == 1 and location <= BANK_1_LAST_LOCATION:
+            if location >= BANK_1_FIRST_DATA_LOCATION:
+                return self.bank_1[location - BANK_1_FIRST_DATA_LOCATION]
+            if location == BANK_1_LOCK_LOCATION:
+                return self.lock_byte
+            return BANK_1_LAST_LOCATION if location == 0 else 0
+        return None
+
+    def write_memory(self, data: int) -> bool:
+        location = self.dtr[0]
+        if not self.write_enabled or self.dtr[1] != 1:
+            return False
+        if location == BANK_1_LOCK_LOCATION:
+            self.lock_byte = data
+        elif BANK_1_FIRST_DATA_LOCATION <= location <= BANK_1_LAST_LOCATION and self.lock_byte == BANK_1_UNLOCK:
+            self.bank_1[location - BANK_1_FIRST_DATA_LOCATION] = data
+        else:
+            return False
+        return True
+
+    def configuration(self, opcode: int) -> None:
+        if 0x40 <= opcode <= 0x4F:
+            self.scene[opcode - 0x40] = self.dtr[0]
+        elif 0x50 <= opcode <= 0x5F:
+            self.scene[opcode - 0x50] = MASK
+        elif 0x60 <= opcode <= 0x6F:
+            self.groups |= 1 << (opcode - 0x60)
+        elif 0x70 <= opcode <= 0x7F:
+            self.groups &= ~(1 << (opcode - 0x70))
+        elif opcode == 0x20:
+            self.reset()
+        elif opcode == 0x21:
+            self.dtr[0] = self.actual_level
+        elif opcode == 0x2A:
+            self.max_level = min(max(self.dtr[0], self.min_level), MAX_LEVEL)
+            self.actual_level = min(self.actual_level, self.max_level)
+        elif opcode == 0x2B:
+            self.min_level = min(max(self.dtr[0], PHYSICAL_MIN_LEVEL), self.max_level)
+            if self.actual_level and self.actual_level < self.min_level:
+                self.actual_level = self.min_level
+        elif opcode == 0x2C:
+            self.system_failure_level = self.dtr[0]
+        elif opcode == 0x2D:
+            self.power_on_level = self.dtr[0]
+        elif opcode == 0x80:
+            self.set_short_address(self.dtr[0])
+        elif opcode == 0x81:
+            self.write_enabled = True
+
+    def query(self, opcode: int):
+        if 0xB0 <= opcode <= 0xBF:
+            return self.scene[opcode - 0xB0]
+        if opcode == 0xC5:
+            value = self.read_memory()
+            if value is not None:
+                self.increment_dtr0()
+            return value
+        answers = {
+            0x90: self.status(),
+            0x91: YES,
+            0x93: YES if self.actual_level else None,
+            0x94: YES if self.limit_error else None,
+            0x95: YES if self.is_reset_state() else None,
+            0x96: YES if self.short_address == MASK else None,
+            0x97: 0x08,
+            0x98: self.dtr[0],
+            0x99: 0xFE,
+            0x9A: PHYSICAL_MIN_LEVEL,
+            0x9C: self.dtr[1],
+            0x9D: self.dtr[2],
+            0xA0: self.actual_level,
+            0xA1: self.max_level,
+            0xA2: self.min_level,
+            0xA3: self.power_on_level,
+            0xA4: self.system_failure_level,
+            0xA5: 0x07,
+            0xC0: self.groups & 0xFF,
+            0xC1: self.groups >> 8,
+            0xC2: (self.random_address >> 16) & 0xFF,
+            0xC3: (self.random_address >> 8) & 0xFF,
+            0xC4: self.random_address & 0xFF,
+        }
+        return answers.get(opcode)
+
+    def command(self, opcode: int, twice: bool):
+        if opcode != 0x81 and opcode < 0x90:
+            self.write_enabled = False
+        if 0x20 <= opcode <= 0x81:
+            if twice:
+                self.configuration(opcode)
+            return None
+        if opcode >= 0x90:
+            return self.query(opcode)
+        if 0x10 <= opcode <= 0x1F:
+            self.set_level(self.scene[opcode - 0x10])
+        elif opcode == 0x00:
+            self.set_level(0)
+        elif opcode == 0x03:
+            if self.actual_level and self.actual_level < self.max_level:
+                self.actual_level += 1
+        elif opcode == 0x04:
+            if self.actual_level > self.min_level:
+                self.actual_level -= 1
+        elif opcode == 0x05:
+            self.set_level(self.max_level)
+        elif opcode == 0x06:
+            self.set_level(self.min_level)
+        elif opcode == 0x07:
+            if self.actual_level <= self.min_level:
+                self.actual_level = 0
+            else:
+                self.actual_level -= 1
+        elif opcode == 0x08:
+            if self.actual_level == 0:
+                self.actual_level = self.min_level
+            elif self.actual_level < self.max_level:
+                self.actual_level += 1
+        return None
+
+    def special(self, address: int, data: int, twice: bool, search_address: int):
+        selected = self.initialise and self.random_address == search_address
+        if address == 0xA1:
+            self.initialise = False
+            self.withdrawn = False
+        elif address in (0xA3, 0xC3, 0xC5):
+            self.dtr[{0xA3: 0, 0xC3: 1, 0xC5: 2}[address]] = data
+        elif address == 0xA5:
+            if twice and (
+                data == 0x00
+                or (data == 0xFF and self.short_address == MASK)
+                or (data & 0x81 == 0x01 and (data >> 1) == self.short_address)
+            ):
+                self.initialise = True
+                self.withdrawn = False
+        elif address == 0xA7:
+            if twice and self.initialise:
+                # the firmware draws a random number, read it back with the random address queries
+                self.random_address = None
+        elif address == 0xA9:
+            if self.initialise and not self.withdrawn and self.random_address <= search_address:
+                return YES
+        elif address == 0xAB:
+            if selected:
+                self.withdrawn = True
+        elif address == 0xB7:
+            if selected:
+                self.set_short_address(data)
+        elif address == 0xB9:
+            if self.initialise and (data >> 1) == self.short_address:
+                return YES
+        elif address == 0xBB:
+            if selected:
+                return MASK if self.short_address == MASK else (self.short_address << 1) | 1
+        elif address in (0xC7, 0xC9):
+            if self.write_memory(data):
+                self.increment_dtr0()
+                if address == 0xC7:
+                    return data
+        return None
+
+
+class GearModel:
+    def __init__(self) -> None:
+        self.gear = []
+        self.search_address = 0
+
+    def clear(self) -> None:
+        self.gear = []
+
+    def add(self, short_address: int) -> None:
+        self.gear.append(Gear(len(self.gear), short_address))
+
+    def receive(self, data: int, twice: bool = False):
+        """Apply a 16 bit forward frame, return the expected backward frame.
+
+        Returns `None` for no answer and `CORRUPT` for colliding answers.
+        """
+        address = (data >> 8) & 0xFF
+        data = data & 0xFF
+        if address in (0xB1, 0xB3, 0xB5):
+            shift = 8 * ((0xB5 - address) // 2)
+            self.search_address = (self.search_address & ~(0xFF << shift)) | (data << shift)
+            return None
+        answers = []
+        for gear in self.gear:
+            if 0xA1 <= address <= 0xCB:
+                answer = gear.special(address, data, twice, self.search_address) if address & 0x01 else None
+            elif not gear.is_addressed(address):
+                answer = None
+            elif address & 0x01:
+                answer = gear.command(data, twice)
+            else:
+                gear.set_level(data)
+                gear.write_enabled = False
+                answer = None
+            if answer is not None:
+                answers.append(answer)
+        if not answers:
+            return None
+        if any(answer != answers[0] for answer in answers):
+            return CORRUPT
+        return answers[0]